@@ -0,0 +1,110 @@
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Bakes the glyphs the editor draws into a mipmapped atlas and writes it out
+// as a C header, so zenkari starts without rasterizing the font or touching
+// the file system. Run by the Makefile: bake_font <font.ttf> <output.h>
+
+// Big enough for the digits in the largest chunk tiles, smaller text is
+// drawn from the mipmaps.
+#define BAKED_FONT_SIZE 128
+#define BAKED_FONT_PADDING 4
+
+// All of printable ASCII, since file names end up in the workspace selector.
+// Anything else is drawn as '?', raylib's fallback glyph.
+#define BAKED_FONT_FIRST_GLYPH 32
+#define BAKED_FONT_LAST_GLYPH 126
+
+void WriteBytes(FILE *file, const unsigned char *bytes, int byteCount)
+{
+	for (int i = 0; i < byteCount; ++i)
+	{
+		fprintf(file, "%s0x%02x,", (i % 20 == 0) ? "\n\t" : " ", bytes[i]);
+	}
+	fprintf(file, "\n");
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "usage: %s <font.ttf> <output.h>\n", argv[0]);
+		return 1;
+	}
+
+	int fileSize = 0;
+	unsigned char *fileData = LoadFileData(argv[1], &fileSize);
+	if (fileData == NULL)
+		return 1;
+
+	int codepointCount = BAKED_FONT_LAST_GLYPH - BAKED_FONT_FIRST_GLYPH + 1;
+	int *codepoints = (int *)malloc(sizeof(*codepoints) * codepointCount);
+	if (codepoints == NULL)
+		return 1;
+	for (int i = 0; i < codepointCount; ++i)
+	{
+		codepoints[i] = BAKED_FONT_FIRST_GLYPH + i;
+	}
+
+	GlyphInfo *glyphs = LoadFontData(fileData, fileSize, BAKED_FONT_SIZE, codepoints, codepointCount, FONT_DEFAULT);
+	Rectangle *recs = NULL;
+	Image atlas = GenImageFontAtlas(glyphs, &recs, codepointCount, BAKED_FONT_SIZE, BAKED_FONT_PADDING, 0);
+	ImageMipmaps(&atlas);
+
+	int atlasSize = GetPixelDataSize(atlas.width, atlas.height, atlas.format);
+	for (int mipmap = 1, width = atlas.width, height = atlas.height; mipmap < atlas.mipmaps; ++mipmap)
+	{
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+		atlasSize += GetPixelDataSize(width, height, atlas.format);
+	}
+
+	int compressedSize = 0;
+	unsigned char *compressed = CompressData((unsigned char *)atlas.data, atlasSize, &compressedSize);
+
+	FILE *file = fopen(argv[2], "w");
+	if (file == NULL)
+		return 1;
+
+	fprintf(file, "// Generated by bake_font from %s, do not edit.\n\n", GetFileName(argv[1]));
+	fprintf(file, "#define BAKED_FONT_BASE_SIZE %d\n", BAKED_FONT_SIZE);
+	fprintf(file, "#define BAKED_FONT_GLYPH_COUNT %d\n", codepointCount);
+	fprintf(file, "#define BAKED_FONT_GLYPH_PADDING %d\n", BAKED_FONT_PADDING);
+	fprintf(file, "#define BAKED_FONT_ATLAS_WIDTH %d\n", atlas.width);
+	fprintf(file, "#define BAKED_FONT_ATLAS_HEIGHT %d\n", atlas.height);
+	fprintf(file, "#define BAKED_FONT_ATLAS_MIPMAPS %d\n", atlas.mipmaps);
+	fprintf(file, "#define BAKED_FONT_ATLAS_FORMAT %d\n", atlas.format);
+	fprintf(file, "#define BAKED_FONT_ATLAS_SIZE %d\n\n", atlasSize);
+
+	fprintf(file, "// Deflated pixels of all mipmap levels\n");
+	fprintf(file, "static const unsigned char bakedFontAtlas[%d] = {", compressedSize);
+	WriteBytes(file, compressed, compressedSize);
+	fprintf(file, "};\n\n");
+
+	fprintf(file, "static Rectangle bakedFontRecs[BAKED_FONT_GLYPH_COUNT] = {\n");
+	for (int i = 0; i < codepointCount; ++i)
+	{
+		fprintf(file, "\t{ %.1ff, %.1ff, %.1ff, %.1ff },\n", recs[i].x, recs[i].y, recs[i].width, recs[i].height);
+	}
+	fprintf(file, "};\n\n");
+
+	fprintf(file, "static GlyphInfo bakedFontGlyphs[BAKED_FONT_GLYPH_COUNT] = {\n");
+	for (int i = 0; i < codepointCount; ++i)
+	{
+		fprintf(file, "\t{ %d, %d, %d, %d, { 0 } },\n", glyphs[i].value, glyphs[i].offsetX, glyphs[i].offsetY, glyphs[i].advanceX);
+	}
+	fprintf(file, "};\n");
+
+	bool isWritten = (ferror(file) == 0);
+	isWritten &= (fclose(file) == 0);
+
+	MemFree(compressed);
+	UnloadImage(atlas);
+	MemFree(recs);
+	UnloadFontData(glyphs, codepointCount);
+	free(codepoints);
+	UnloadFileData(fileData);
+
+	return isWritten ? 0 : 1;
+}
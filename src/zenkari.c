@@ -1,20 +1,99 @@
 #include <raylib.h>
 #include <raymath.h>
+#include <rlgl.h>
 #include <assert.h>
+#include <errno.h>
 #include <math.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <raylib.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+// From GLFW, which comes linked into libraylib. Wakes up the main thread
+// while it waits for input events, and may be called from any thread.
+void glfwPostEmptyEvent(void);
+
+// Generated from assets/oswald.ttf by bake_font, see the Makefile
+#include "baked_font.h"
 
 #define TILE_SIZE 64
 
+// Largest width or height a level file may have
+#define LEVEL_MAX_TILE_COUNT 2048
+
+#define AUTOSAVE_PATH "autosave.zenkari.z"
+#define AUTOSAVE_INTERVAL_SECONDS 30.0
+
+#define JOB_MAX_WORKERS 16
+
+// Heap allocations go through these, so the debug panel can count them
+#define ZK_MALLOC(size) CountHeapAllocation(malloc(size))
+#define ZK_CALLOC(count, size) CountHeapAllocation(calloc(count, size))
+#define ZK_REALLOC(ptr, size) CountHeapAllocation(realloc(ptr, size))
+
+// Whole level passes on fewer tiles than this are not worth splitting over threads
+#define PARALLEL_MIN_TILES (256 * 256)
+// Tasks per thread, so uneven rows even out
+#define PARALLEL_TASKS_PER_THREAD 4
+
+// The level is pre-rendered into square chunks of CHUNK_TEXTURE_SIZE texels.
+// How many tiles a chunk covers depends on the zoom, so a chunk always shows
+// up on screen at between half and full texture resolution.
+#define CHUNK_TEXTURE_SIZE 512
+#define CHUNK_MIN_TEXELS_PER_TILE 8
+#define CHUNK_MAX_TEXELS_PER_TILE 128
+#define CHUNK_EVICT_AFTER_FRAMES 90
+
+// Below this many screen pixels per tile the level is drawn from the overview
+// texture, with one texel per tile, instead of from the chunks.
+#define OVERVIEW_MAX_PIXELS_PER_TILE 4.0f
+
+#define PACK_MAGIC "ZKPK"
+#define PACK_VERSION 1
+
+// Inactive workspace levels beyond this many tiles in total are unloaded,
+// least recently used first. Levels with unsaved changes are kept.
+#define WORKSPACE_MAX_LOADED_TILES (16 * 1024 * 1024)
+
+// A reload that changes more tiles than this relights and checks the whole
+// level, which is faster than doing it around each tile.
+#define RELOAD_MAX_TILES_AROUND 64
+
+#define THUMBNAIL_SIZE 96
+#define THUMBNAIL_MAX_PENDING 8
+// Thumbnails further than this from the selector are unloaded
+#define THUMBNAIL_KEEP_DISTANCE 256
+
+#define SELECTOR_PAD 8
+#define SELECTOR_LABEL_HEIGHT 20
+#define SELECTOR_SLOT_WIDTH (THUMBNAIL_SIZE + SELECTOR_PAD)
+#define SELECTOR_HEIGHT (THUMBNAIL_SIZE + SELECTOR_LABEL_HEIGHT + 2 * SELECTOR_PAD)
+
+// Lamp requirements go from 0 to 4
+#define DIGIT_COUNT 5
+
+#define COLOR_GRID_LINE (CLITERAL(Color){0xf0, 0xf0, 0xf0, 0xff})
+
 #define COLOR_WALL (CLITERAL(Color){0x45, 0x56, 0x60, 0xff})
 #define COLOR_LAMP (CLITERAL(Color){0xcc, 0xee, 0x30, 0xff})
 #define COLOR_LIT (CLITERAL(Color){251, 241, 218, 255})
 #define COLOR_BACKGROUND (CLITERAL(Color){0xe0, 0xe0, 0xe5, 0xff})
 #define COLOR_BACKGROUND_PLAY (CLITERAL(Color){0xe0, 0xf5, 0xf0, 0xff})
 #define COLOR_BACKGROUND_PUZZLE_SOLVED (CLITERAL(Color){0xf5, 0xf5, 0xa3, 0xFF})
+#define COLOR_BRANCH_LAMP (CLITERAL(Color){0x3a, 0x8e, 0xe6, 0xff})
 
 typedef enum TileKind
 {
@@ -32,11 +111,17 @@ typedef struct Tile
 	int lampRequirement;
 } Tile;
 
+// Tiles are stored row by row inside a border of walls, so walks across the
+// level stop at the border without checking bounds. Rows are stride tiles
+// apart and capacityY rows are allocated, the slack lets the level grow in
+// place.
 typedef struct Level
 {
 	int tileCountX;
 	int tileCountY;
 	Tile *tiles;
+	int stride;
+	int capacityY;
 } Level;
 
 typedef enum ViolationKind
@@ -52,13 +137,292 @@ typedef struct Violation
 	int tileY;
 } Violation;
 
+// Bump allocator for data that is thrown away all at once. What does not fit
+// goes to the heap until the next reset, which grows the block to fit it.
+typedef struct Arena
+{
+	unsigned char *memory;
+	size_t capacity;
+	size_t used;
+	// Bytes asked for since the last reset, overflow included
+	size_t requested;
+	void **overflow;
+	int overflowCount;
+	int overflowCapacity;
+} Arena;
+
 typedef struct Violations
 {
 	Violation *items;
 	int count;
 	int capacity;
+	// Items are carved from here, or from the heap when NULL
+	Arena *arena;
 } Violations;
 
+typedef struct TileRect
+{
+	// Half-open range of tiles: [minX, maxX) x [minY, maxY)
+	int minX;
+	int minY;
+	int maxX;
+	int maxY;
+} TileRect;
+
+// Wall tiles with their lamp requirement digit, pre-rendered side by side,
+// followed by one plain white cell that untextured quads sample from.
+typedef struct DigitAtlas
+{
+	RenderTexture2D target;
+	int cellSize;
+} DigitAtlas;
+
+typedef struct Chunk
+{
+	RenderTexture2D target;
+	bool isLoaded;
+	bool isDirty;
+	unsigned int lastUsedFrame;
+} Chunk;
+
+typedef struct LevelOverview
+{
+	int tileCountX;
+	int tileCountY;
+	Image image;
+	Texture2D texture;
+	bool isLoaded;
+
+	// Per row, the half-open span of tiles whose texel is out of date
+	int *dirtyMinX;
+	int *dirtyMaxX;
+	int dirtyMinY;
+	int dirtyMaxY;
+} LevelOverview;
+
+typedef struct LevelRenderCache
+{
+	// Layout the chunks were made for, a change of any of these drops them all
+	int tileCountX;
+	int tileCountY;
+	int texelsPerTile;
+
+	int chunkTiles;
+	int chunkCountX;
+	int chunkCountY;
+	Chunk *chunks;
+
+	int *loadedChunks;
+	int loadedCount;
+	int loadedCapacity;
+
+	unsigned int frame;
+
+	LevelOverview overview;
+} LevelRenderCache;
+
+typedef void (*JobFunction)(void *data);
+
+typedef struct Job
+{
+	// Runs on a worker thread
+	JobFunction run;
+	// Optional, runs on the main thread once per frame after run has finished
+	JobFunction complete;
+	void *data;
+} Job;
+
+// Per worker deque. The owner takes the newest job, thieves the oldest.
+typedef struct JobQueue
+{
+	pthread_mutex_t mutex;
+	Job *jobs;
+	int capacity;
+	int head;
+	int count;
+} JobQueue;
+
+typedef struct JobSystem
+{
+	int workerCount;
+	pthread_t threads[JOB_MAX_WORKERS];
+	JobQueue queues[JOB_MAX_WORKERS];
+	pthread_key_t workerKey;
+	int nextQueue;
+
+	// Guards the counters, workers sleep on wake while nothing is queued
+	pthread_mutex_t mutex;
+	pthread_cond_t wake;
+	pthread_cond_t idle;
+	int queuedCount;
+	int activeCount;
+	bool shouldQuit;
+
+	// Jobs whose completion still has to run on the main thread
+	pthread_mutex_t completedMutex;
+	Job *completed;
+	int completedCount;
+	int completedCapacity;
+	int pendingCompletionCount;
+} JobSystem;
+
+// Processes items [begin, end), task is the index of the range.
+typedef void (*RangeFunction)(void *data, int task, int begin, int end);
+
+// Shared between the calling thread and the helper jobs. Helpers that start
+// after all tasks are taken only drop their reference, so the caller never
+// waits on a helper stuck behind some unrelated long job.
+typedef struct ParallelBatch
+{
+	RangeFunction function;
+	void *data;
+	int count;
+	int taskSize;
+	int taskCount;
+	int nextTask;
+	int finishedTaskCount;
+	int refCount;
+	pthread_mutex_t mutex;
+	pthread_cond_t done;
+} ParallelBatch;
+
+// Read-only copy of a level that jobs can hold on to while the editor moves on.
+typedef struct LevelSnapshot
+{
+	Level level;
+	int refCount;
+} LevelSnapshot;
+
+typedef struct Autosave
+{
+	bool isLevelModified;
+	bool isSaving;
+	double lastSaveTime;
+} Autosave;
+
+// Wakes the main loop out of waiting for input once a deadline has passed.
+typedef struct WakeTimer
+{
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t changed;
+	bool isArmed;
+	struct timespec deadline;
+} WakeTimer;
+
+// A level pack is one file holding many levels:
+//
+//     PackHeader
+//     PackEntry[levelCount]
+//     payloads
+//
+// Payloads are level text as in a .zenkari file, each ending in a zero
+// byte. All fields are little-endian.
+typedef struct PackHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t levelCount;
+	uint32_t reserved;
+} PackHeader;
+
+typedef struct PackEntry
+{
+	// From the start of the file
+	uint64_t offset;
+	uint32_t size;
+	uint32_t tileCountX;
+	uint32_t tileCountY;
+	// FNV-1a of the payload
+	uint32_t hash;
+} PackEntry;
+
+// Mapped into memory where possible, so opening a level only touches its payload.
+typedef struct LevelPack
+{
+	char *path;
+	unsigned char *data;
+	size_t size;
+	bool isMapped;
+	const PackEntry *entries;
+	int levelCount;
+} LevelPack;
+
+// Where a level comes from, either a file or a level in a pack.
+typedef struct LevelSource
+{
+	const char *path;
+	LevelPack *pack;
+	int packIndex;
+} LevelSource;
+
+// A level in the workspace. Only its dimensions are read up front, the level
+// itself is parsed when first needed.
+typedef struct WorkspaceEntry
+{
+	LevelSource source;
+	int tileCountX;
+	int tileCountY;
+	// Tiles are set while the level is loaded but not active. The active
+	// level lives in Editor.level.
+	Level level;
+	bool isModified;
+	bool isLoading;
+	int lastUsed;
+	Texture2D thumbnail;
+	bool isThumbnailPending;
+	bool isThumbnailStale;
+} WorkspaceEntry;
+
+typedef struct Workspace
+{
+	WorkspaceEntry *entries;
+	int count;
+	int capacity;
+	// -1 while editing a level that is not in the workspace
+	int active;
+	// Level to switch to once a worker has loaded it, or -1
+	int pendingActive;
+	int useCounter;
+	int pendingThumbnailCount;
+} Workspace;
+
+// Watches the directory of the open level file, since scripts and editors
+// often replace a file instead of writing into it.
+typedef struct FileWatch
+{
+	// -1 where inotify is not available
+	int fd;
+	pthread_t thread;
+
+	// Guards the fields below, the thread reads the events
+	pthread_mutex_t mutex;
+	int watch;
+	// Owned by the workspace entry, NULL while nothing is watched
+	const char *path;
+	bool hasChanged;
+} FileWatch;
+
+// A tile changed inside a branch, with what it was before.
+typedef struct BranchDelta
+{
+	int tileX;
+	int tileY;
+	TileKind previousKind;
+} BranchDelta;
+
+// Play mode "what if" layers. Every open branch owns the deltas from its mark
+// to the next one, so discarding a branch only undoes those.
+typedef struct Branches
+{
+	BranchDelta *deltas;
+	int count;
+	int capacity;
+	int *marks;
+	int markCount;
+	int markCapacity;
+} Branches;
+
 typedef enum Mode
 {
 	MODE_EDIT,
@@ -78,755 +442,4033 @@ typedef struct Editor
 	float previousZoom;
 
 	Violations violations;
+	LevelRenderCache renderCache;
+
+	JobSystem jobs;
+	LevelSnapshot *levelSnapshot;
+	bool isLevelSnapshotStale;
+	Autosave autosave;
+	WakeTimer wakeTimer;
+	Workspace workspace;
+	Branches branches;
+	FileWatch fileWatch;
 
 	Font font;
+	DigitAtlas digits;
 
 	bool showDebugText;
-} Editor;
 
-void DrawTileGridLines(int tileCountX, int tileCountY)
-{
-	int width = tileCountX * TILE_SIZE;
-	int height = tileCountY * TILE_SIZE;
+	// Rectangle fill or clear in progress, from the start tile to the mouse tile
+	bool isSelecting;
+	bool isSelectionClear;
+	int selectionStartX;
+	int selectionStartY;
+	int selectionEndX;
+	int selectionEndY;
+
+	// Violations and the solved state are only recomputed when the level changed
+	bool isLevelDirty;
+	bool isPuzzleSolved;
+	// Changed, but lighting and violations are already updated around the change
+	bool isLevelTouched;
+	// Empty tiles no lamp reaches, kept up to date along with the violations
+	int unlitTileCount;
+
+	// Frames are only drawn when something could have changed on screen
+	bool needsRedraw;
+	bool isInteracting;
+
+	// Reset at the top of every Update
+	Arena frameArena;
+	// Reset whenever the violations are recomputed from scratch, holds them
+	Arena levelArena;
+	int heapAllocationCountAtFrameStart;
+	int lastFrameHeapAllocationCount;
+} Editor;
 
-	for (int i = 0; i <= tileCountX; ++i)
-	{
-		float x = i * TILE_SIZE;
-		DrawLine(x, 0, x, height, GetColor(0xf0f0f0ff));
-	}
+// Counts every heap allocation made through ZK_MALLOC and friends, on any thread.
+static int heapAllocationCount;
 
-	for (int i = 0; i <= tileCountY; ++i)
-	{
-		float y = i * TILE_SIZE;
-		DrawLine(0, y, width, y, GetColor(0xf0f0f0ff));
-	}
+void *CountHeapAllocation(void *memory)
+{
+	__atomic_add_fetch(&heapAllocationCount, 1, __ATOMIC_RELAXED);
+	return memory;
 }
 
-int Modulo(int n, int m)
+int GetHeapAllocationCount(void)
 {
-	return ((n % m) + m) % m;
+	return __atomic_load_n(&heapAllocationCount, __ATOMIC_RELAXED);
 }
 
-void DrawTileWithAlpha(Tile tile, int tileX, int tileY, Font font, float alpha)
+// Not thread safe, arenas belong to the main thread.
+void *ArenaAlloc(Arena *arena, size_t size)
 {
-	Color color;
-	switch (tile.kind)
+	size = (size + 15) & ~(size_t)15;
+	arena->requested += size;
+
+	if (arena->used + size <= arena->capacity)
 	{
-		case TILE_EMPTY: return;
-		case TILE_LIT: color = COLOR_LIT; break;
-		case TILE_WALL: color = COLOR_WALL; break;
-		case TILE_LAMP: color = COLOR_LAMP; break;
-		default:
-			break;
+		void *memory = arena->memory + arena->used;
+		arena->used += size;
+		return memory;
 	}
 
-	Vector2 tileCorner = {
-		tileX * TILE_SIZE,
-		tileY * TILE_SIZE,
-	};
-	DrawRectangle(tileCorner.x, tileCorner.y, TILE_SIZE, TILE_SIZE, ColorAlpha(color, alpha));
-
-	if (tile.kind == TILE_WALL && tile.lampRequirement >= 0)
+	if (arena->overflowCount == arena->overflowCapacity)
 	{
-		Vector2 tileDim = {TILE_SIZE, TILE_SIZE};
-		Vector2 tileCenter = Vector2Add(tileCorner, Vector2Scale(tileDim, 0.5f));
-		char lampCountText[12] = {0};
-		snprintf(lampCountText, sizeof(lampCountText), "%d", tile.lampRequirement);
-		float fontSize = TILE_SIZE * 0.61803398875f;
-		Vector2 textDimensions = MeasureTextEx(font, lampCountText, fontSize, 0);
-		Vector2 textCorner = Vector2Subtract(tileCenter, Vector2Scale(textDimensions, 0.5f));
-		DrawTextEx(font, lampCountText, textCorner, fontSize, 0, WHITE);
+		arena->overflowCapacity = arena->overflowCapacity ? 2 * arena->overflowCapacity : 16;
+		arena->overflow = ZK_REALLOC(arena->overflow, sizeof(arena->overflow[0]) * arena->overflowCapacity);
+		assert(arena->overflow != NULL);
 	}
+
+	void *memory = ZK_MALLOC(size);
+	assert(memory != NULL);
+	arena->overflow[arena->overflowCount++] = memory;
+	return memory;
 }
 
-void DrawTile(Tile tile, int tileX, int tileY, Font font)
+void *ArenaCalloc(Arena *arena, size_t count, size_t size)
 {
-	DrawTileWithAlpha(tile, tileX, tileY, font, 1.0f);
+	void *memory = ArenaAlloc(arena, count * size);
+	memset(memory, 0, count * size);
+	return memory;
 }
 
-bool IsTileInLevel(Level level, int tileX, int tileY)
+// Formatted text that stays valid until the arena is reset.
+const char *ArenaFormat(Arena *arena, const char *format, ...)
 {
-	return tileX >= 0 && tileX < level.tileCountX
-		&& tileY >= 0 && tileY < level.tileCountY;
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+
+	char *text = (char *)ArenaAlloc(arena, length + 1);
+	va_start(args, format);
+	vsnprintf(text, length + 1, format, args);
+	va_end(args);
+	return text;
 }
 
-int GetTileIndex(Level level, int tileX, int tileY)
+// Frees everything handed out. If the block was too small this time, it is
+// regrown with some slack, so the same usage fits without touching the heap.
+void ResetArena(Arena *arena)
 {
-	assert(IsTileInLevel(level, tileX, tileY));
-	return tileX + tileY * level.tileCountX;
+	for (int i = 0; i < arena->overflowCount; ++i)
+	{
+		free(arena->overflow[i]);
+	}
+	arena->overflowCount = 0;
+
+	if (arena->requested > arena->capacity)
+	{
+		free(arena->memory);
+		arena->capacity = arena->requested + arena->requested / 2;
+		arena->memory = (unsigned char *)ZK_MALLOC(arena->capacity);
+		assert(arena->memory != NULL);
+	}
+
+	arena->used = 0;
+	arena->requested = 0;
 }
 
-void DrawTileGrid(Level level, Font font)
+void PushJob(JobQueue *queue, Job job)
 {
-	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	pthread_mutex_lock(&queue->mutex);
+	if (queue->count == queue->capacity)
 	{
-		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
+		int capacity = queue->capacity ? 2 * queue->capacity : 64;
+		Job *jobs = (Job *)ZK_MALLOC(sizeof(*jobs) * capacity);
+		assert(jobs != NULL);
+		for (int i = 0; i < queue->count; ++i)
 		{
-			Tile tile = level.tiles[GetTileIndex(level, tileX, tileY)];
-			DrawTile(tile, tileX, tileY, font);
+			jobs[i] = queue->jobs[(queue->head + i) % queue->capacity];
 		}
+		free(queue->jobs);
+		queue->jobs = jobs;
+		queue->capacity = capacity;
+		queue->head = 0;
 	}
+	queue->jobs[(queue->head + queue->count) % queue->capacity] = job;
+	++queue->count;
+	pthread_mutex_unlock(&queue->mutex);
 }
 
-void TileFromVector2(Vector2 worldPosition, int *tileX, int *tileY)
+bool TryPopJob(JobQueue *queue, Job *outJob)
 {
-	*tileX = worldPosition.x / TILE_SIZE;
-	*tileY = worldPosition.y / TILE_SIZE;
-	if (worldPosition.x < 0) --*tileX;
-	if (worldPosition.y < 0) --*tileY;
+	bool found = false;
+	pthread_mutex_lock(&queue->mutex);
+	if (queue->count > 0)
+	{
+		--queue->count;
+		*outJob = queue->jobs[(queue->head + queue->count) % queue->capacity];
+		found = true;
+	}
+	pthread_mutex_unlock(&queue->mutex);
+	return found;
 }
 
-Vector2 GetMouseWorldPosition(Camera2D camera)
+bool TryStealJob(JobQueue *queue, Job *outJob)
 {
-	return GetScreenToWorld2D(GetMousePosition(), camera);
+	bool found = false;
+	pthread_mutex_lock(&queue->mutex);
+	if (queue->count > 0)
+	{
+		*outJob = queue->jobs[queue->head];
+		queue->head = (queue->head + 1) % queue->capacity;
+		--queue->count;
+		found = true;
+	}
+	pthread_mutex_unlock(&queue->mutex);
+	return found;
 }
 
-void GetMouseTile(Camera2D camera, int *mouseTileX, int *mouseTileY)
+// Index of the calling worker, or -1 on any other thread.
+int GetWorkerIndex(JobSystem *system)
 {
-	Vector2 worldPosition = GetMouseWorldPosition(camera);
-	TileFromVector2(worldPosition, mouseTileX, mouseTileY);
+	return (int)(intptr_t)pthread_getspecific(system->workerKey) - 1;
 }
 
-void DrawTileOutline(int tileX, int tileY, float thick, Color color)
+// Own queue first, then steal from the others.
+bool TryTakeJob(JobSystem *system, Job *outJob)
 {
-	Rectangle tileRect = {
-		tileX,
-		tileY,
-		TILE_SIZE,
-		TILE_SIZE,
-	};
+	int workerIndex = GetWorkerIndex(system);
+	bool found = workerIndex >= 0 && TryPopJob(&system->queues[workerIndex], outJob);
 
-	DrawRectangleLinesEx(tileRect, thick, color);
+	for (int i = 1; !found && i <= system->workerCount; ++i)
+	{
+		int victim = (workerIndex + i + system->workerCount) % system->workerCount;
+		found = TryStealJob(&system->queues[victim], outJob);
+	}
+
+	if (found)
+	{
+		pthread_mutex_lock(&system->mutex);
+		--system->queuedCount;
+		pthread_mutex_unlock(&system->mutex);
+	}
+
+	return found;
 }
 
-void DrawTileCursor(Editor *editor)
+void RunJob(JobSystem *system, Job job)
 {
-	int mouseTileX;
-	int mouseTileY;
-	GetMouseTile(editor->camera, &mouseTileX, &mouseTileY);
-
-	Vector2 tilePosition = {mouseTileX * TILE_SIZE, mouseTileY * TILE_SIZE};
+	job.run(job.data);
 
-	if (editor->tileToDraw.kind == TILE_EMPTY)
+	if (job.complete != NULL)
 	{
-		DrawLineEx(
-			CLITERAL(Vector2){mouseTileX * TILE_SIZE, mouseTileY * TILE_SIZE},
-			CLITERAL(Vector2){(mouseTileX + 1) * TILE_SIZE, (mouseTileY + 1) * TILE_SIZE},
-			3.0f,
-			RED);
-		DrawLineEx(
-			CLITERAL(Vector2){mouseTileX * TILE_SIZE, (mouseTileY + 1) * TILE_SIZE},
-			CLITERAL(Vector2){(mouseTileX + 1) * TILE_SIZE, mouseTileY * TILE_SIZE},
-			3.0f,
-			RED);		
+		pthread_mutex_lock(&system->completedMutex);
+		if (system->completedCount == system->completedCapacity)
+		{
+			system->completedCapacity = system->completedCapacity ? 2 * system->completedCapacity : 16;
+			system->completed = (Job *)ZK_REALLOC(system->completed, sizeof(*system->completed) * system->completedCapacity);
+			assert(system->completed != NULL);
+		}
+		system->completed[system->completedCount++] = job;
+		pthread_mutex_unlock(&system->completedMutex);
 	}
-	else
+
+	pthread_mutex_lock(&system->mutex);
+	if (--system->activeCount == 0)
 	{
-		DrawTileWithAlpha(editor->tileToDraw, mouseTileX, mouseTileY, editor->font, 0.4f);
-		DrawTileOutline(tilePosition.x, tilePosition.y, 4, ColorAlpha(WHITE, 0.5f));
+		pthread_cond_broadcast(&system->idle);
 	}
+	pthread_mutex_unlock(&system->mutex);
 }
 
-Tile *GetTile(Level level, int tileX, int tileY)
+typedef struct JobWorker
 {
-	return &level.tiles[GetTileIndex(level, tileX, tileY)];
-}
+	JobSystem *system;
+	int index;
+} JobWorker;
 
-bool TryGetTile(Level level, int tileX, int tileY, Tile **outTile)
+void *JobWorkerThread(void *data)
 {
-	if (!IsTileInLevel(level, tileX, tileY))
+	JobWorker worker = *(JobWorker *)data;
+	free(data);
+
+	JobSystem *system = worker.system;
+	pthread_setspecific(system->workerKey, (void *)(intptr_t)(worker.index + 1));
+
+	for (;;)
 	{
-		return false;
+		Job job;
+		if (TryTakeJob(system, &job))
+		{
+			RunJob(system, job);
+			continue;
+		}
+
+		pthread_mutex_lock(&system->mutex);
+		while (system->queuedCount <= 0 && !system->shouldQuit)
+		{
+			pthread_cond_wait(&system->wake, &system->mutex);
+		}
+		bool shouldQuit = system->shouldQuit && system->queuedCount <= 0;
+		pthread_mutex_unlock(&system->mutex);
+
+		if (shouldQuit)
+			break;
 	}
-	
-	*outTile = GetTile(level, tileX, tileY);
-	return true;
+
+	return NULL;
 }
 
-void PutTile(Level level, int tileX, int tileY, Tile tile)
+int GetProcessorCount(void)
 {
-	if (!IsTileInLevel(level, tileX, tileY))
-		return;
-
-	*GetTile(level, tileX, tileY) = tile;
+#ifdef _WIN32
+	const char *processorCount = getenv("NUMBER_OF_PROCESSORS");
+	return processorCount ? atoi(processorCount) : 1;
+#else
+	return (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
 }
 
-void AddViolation(Violations *violations, Violation violation)
+// One worker per core, leaving a core for the main thread.
+void StartJobSystem(JobSystem *system)
 {
-	if (violations->count + 1 >= violations->capacity)
+	*system = CLITERAL(JobSystem){0};
+
+	system->workerCount = GetProcessorCount() - 1;
+	if (system->workerCount < 1) system->workerCount = 1;
+	if (system->workerCount > JOB_MAX_WORKERS) system->workerCount = JOB_MAX_WORKERS;
+
+	pthread_key_create(&system->workerKey, NULL);
+	pthread_mutex_init(&system->mutex, NULL);
+	pthread_cond_init(&system->wake, NULL);
+	pthread_cond_init(&system->idle, NULL);
+	pthread_mutex_init(&system->completedMutex, NULL);
+
+	for (int i = 0; i < system->workerCount; ++i)
 	{
-		violations->capacity *= 2;
-		if (violations->capacity == 0)
-		{
-			violations->capacity = 8;
-		}
-		violations->items = realloc(violations->items, sizeof(violations->items[0]) * violations->capacity);
-		assert(violations->items != NULL);
+		pthread_mutex_init(&system->queues[i].mutex, NULL);
 	}
 
-	violations->items[violations->count] = violation;
-	++violations->count;
+	for (int i = 0; i < system->workerCount; ++i)
+	{
+		JobWorker *worker = (JobWorker *)ZK_MALLOC(sizeof(*worker));
+		assert(worker != NULL);
+		*worker = CLITERAL(JobWorker){system, i};
+		pthread_create(&system->threads[i], NULL, JobWorkerThread, worker);
+	}
 }
 
-bool GetLampRequirementViolations(Level level, Violations *violations)
+// From a worker the job goes to its own queue, otherwise round robin.
+void SubmitJob(JobSystem *system, Job job)
 {
-	bool foundViolation = false;
+	int queueIndex = GetWorkerIndex(system);
+	if (queueIndex < 0)
+	{
+		queueIndex = system->nextQueue;
+		system->nextQueue = (system->nextQueue + 1) % system->workerCount;
+	}
 
-	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	pthread_mutex_lock(&system->mutex);
+	++system->activeCount;
+	if (job.complete != NULL)
 	{
-		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
-		{
-			Tile tile = level.tiles[GetTileIndex(level, tileX, tileY)];
-			if (tile.kind != TILE_WALL)
-			{
-				continue;
-			}
+		++system->pendingCompletionCount;
+	}
+	pthread_mutex_unlock(&system->mutex);
 
-			int lampsNeeded = tile.lampRequirement;
+	PushJob(&system->queues[queueIndex], job);
 
-			if (lampsNeeded == -1)
-				continue;
+	pthread_mutex_lock(&system->mutex);
+	++system->queuedCount;
+	pthread_cond_signal(&system->wake);
+	pthread_mutex_unlock(&system->mutex);
+}
 
-			// tile is a wall
-			Tile *neighborTile = NULL;
+// Main thread only, once per frame.
+void RunCompletedJobs(JobSystem *system)
+{
+	pthread_mutex_lock(&system->completedMutex);
+	Job *completed = system->completed;
+	int completedCount = system->completedCount;
+	system->completed = NULL;
+	system->completedCount = 0;
+	system->completedCapacity = 0;
+	pthread_mutex_unlock(&system->completedMutex);
+
+	for (int i = 0; i < completedCount; ++i)
+	{
+		completed[i].complete(completed[i].data);
+	}
+	free(completed);
 
-			if (TryGetTile(level, tileX - 1, tileY, &neighborTile) && (neighborTile->kind == TILE_LAMP))
-			{
-				--lampsNeeded;
-			}
+	if (completedCount > 0)
+	{
+		pthread_mutex_lock(&system->mutex);
+		system->pendingCompletionCount -= completedCount;
+		pthread_mutex_unlock(&system->mutex);
+	}
+}
 
-			if (TryGetTile(level, tileX + 1, tileY, &neighborTile) && (neighborTile->kind == TILE_LAMP))
-			{
-				--lampsNeeded;
-			}
+bool HasPendingCompletions(JobSystem *system)
+{
+	pthread_mutex_lock(&system->mutex);
+	bool hasPending = system->pendingCompletionCount > 0;
+	pthread_mutex_unlock(&system->mutex);
+	return hasPending;
+}
 
-			if (TryGetTile(level, tileX, tileY - 1, &neighborTile) && (neighborTile->kind == TILE_LAMP))
-			{
-				--lampsNeeded;
-			}
+// Help out until every submitted job has run, then run their completions.
+void WaitForAllJobs(JobSystem *system)
+{
+	Job job;
+	while (TryTakeJob(system, &job))
+	{
+		RunJob(system, job);
+	}
 
-			if (TryGetTile(level, tileX, tileY + 1, &neighborTile) && (neighborTile->kind == TILE_LAMP))
-			{
-				--lampsNeeded;
-			}
+	pthread_mutex_lock(&system->mutex);
+	while (system->activeCount > 0)
+	{
+		pthread_cond_wait(&system->idle, &system->mutex);
+	}
+	pthread_mutex_unlock(&system->mutex);
 
-			if (lampsNeeded != 0)
-			{
-				if (violations == NULL)
-				{
-					return true;
-				}
+	RunCompletedJobs(system);
+}
 
-				foundViolation = true;
-				AddViolation(violations, CLITERAL(Violation){
-					.kind = VIOLATION_LAMP_REQUIREMENT,
-					.tileX = tileX,
-					.tileY = tileY,
-				});
-			}
-		}
+void StopJobSystem(JobSystem *system)
+{
+	WaitForAllJobs(system);
+
+	pthread_mutex_lock(&system->mutex);
+	system->shouldQuit = true;
+	pthread_cond_broadcast(&system->wake);
+	pthread_mutex_unlock(&system->mutex);
+
+	for (int i = 0; i < system->workerCount; ++i)
+	{
+		pthread_join(system->threads[i], NULL);
+		free(system->queues[i].jobs);
 	}
-	return foundViolation;
 }
 
-bool GetLampLitByOtherLampViolations(Level level, Violations *violations)
+void RunParallelBatchTasks(ParallelBatch *batch)
 {
-	bool foundViolation = false;
+	int finishedTaskCount = 0;
 
-	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	for (;;)
 	{
-		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
-		{
-			Tile tile = level.tiles[GetTileIndex(level, tileX, tileY)];
-			if (tile.kind != TILE_LAMP)
-			{
-				continue;
-			}
+		int task = __atomic_fetch_add(&batch->nextTask, 1, __ATOMIC_RELAXED);
+		if (task >= batch->taskCount)
+			break;
 
-			Tile *checkTile = NULL;
+		int begin = task * batch->taskSize;
+		int end = begin + batch->taskSize;
+		if (end > batch->count) end = batch->count;
 
-			// Check row to the right
-			for (int checkX = tileX + 1; checkX < level.tileCountX; ++checkX)
+		batch->function(batch->data, task, begin, end);
+		++finishedTaskCount;
+	}
+
+	if (finishedTaskCount > 0)
+	{
+		pthread_mutex_lock(&batch->mutex);
+		batch->finishedTaskCount += finishedTaskCount;
+		if (batch->finishedTaskCount == batch->taskCount)
+		{
+			pthread_cond_signal(&batch->done);
+		}
+		pthread_mutex_unlock(&batch->mutex);
+	}
+}
+
+void ReleaseParallelBatch(ParallelBatch *batch)
+{
+	if (__atomic_sub_fetch(&batch->refCount, 1, __ATOMIC_ACQ_REL) == 0)
+	{
+		pthread_mutex_destroy(&batch->mutex);
+		pthread_cond_destroy(&batch->done);
+		free(batch);
+	}
+}
+
+void RunParallelBatchHelperJob(void *data)
+{
+	ParallelBatch *batch = (ParallelBatch *)data;
+	RunParallelBatchTasks(batch);
+	ReleaseParallelBatch(batch);
+}
+
+// How many ranges ParallelFor will split count items into. One without a job
+// system or for too little work.
+int GetParallelTaskCount(JobSystem *system, int count, int tileCount)
+{
+	if (system == NULL || tileCount < PARALLEL_MIN_TILES)
+		return 1;
+
+	int taskCount = (system->workerCount + 1) * PARALLEL_TASKS_PER_THREAD;
+	return taskCount < count ? taskCount : (count > 0 ? count : 1);
+}
+
+// Split [0, count) into taskCount ranges and process them on the workers and
+// the calling thread. Returns when all ranges are done.
+void ParallelFor(JobSystem *system, int count, int taskCount, RangeFunction function, void *data)
+{
+	// Rounding the task size up can leave the last tasks without items, drop
+	// those so every range is non-empty
+	int taskSize = (count > 0 && taskCount > 1) ? (count + taskCount - 1) / taskCount : count;
+	if (taskSize > 0)
+	{
+		taskCount = (count + taskSize - 1) / taskSize;
+	}
+
+	if (system == NULL || taskCount <= 1)
+	{
+		function(data, 0, 0, count);
+		return;
+	}
+
+	ParallelBatch *batch = (ParallelBatch *)ZK_MALLOC(sizeof(*batch));
+	assert(batch != NULL);
+	*batch = CLITERAL(ParallelBatch){
+		.function = function,
+		.data = data,
+		.count = count,
+		.taskSize = taskSize,
+		.taskCount = taskCount,
+	};
+	pthread_mutex_init(&batch->mutex, NULL);
+	pthread_cond_init(&batch->done, NULL);
+
+	int helperCount = system->workerCount < taskCount - 1 ? system->workerCount : taskCount - 1;
+	batch->refCount = helperCount + 1;
+	for (int i = 0; i < helperCount; ++i)
+	{
+		SubmitJob(system, CLITERAL(Job){RunParallelBatchHelperJob, NULL, batch});
+	}
+
+	RunParallelBatchTasks(batch);
+
+	pthread_mutex_lock(&batch->mutex);
+	while (batch->finishedTaskCount < batch->taskCount)
+	{
+		pthread_cond_wait(&batch->done, &batch->mutex);
+	}
+	pthread_mutex_unlock(&batch->mutex);
+
+	ReleaseParallelBatch(batch);
+}
+
+int Modulo(int n, int m)
+{
+	return ((n % m) + m) % m;
+}
+
+// Like BLEND_ALPHA, but accumulates destination alpha instead of scaling it,
+// so translucent glyph edges do not punch holes into an opaque render texture.
+void BeginRenderTextureBlendMode(void)
+{
+	rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+	BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+}
+
+// Re-render the digits when the wanted resolution changed, which only happens
+// when the zoom crosses into another bucket.
+void BakeDigitAtlas(DigitAtlas *atlas, Font font, int cellSize)
+{
+	if (atlas->cellSize == cellSize)
+		return;
+
+	if (atlas->cellSize != 0)
+	{
+		UnloadRenderTexture(atlas->target);
+	}
+
+	atlas->target = LoadRenderTexture((DIGIT_COUNT + 1) * cellSize, cellSize);
+	atlas->cellSize = cellSize;
+	SetTextureFilter(atlas->target.texture, TEXTURE_FILTER_BILINEAR);
+	SetTextureWrap(atlas->target.texture, TEXTURE_WRAP_CLAMP);
+
+	static const char *digitTexts[DIGIT_COUNT] = {"0", "1", "2", "3", "4"};
+	float fontSize = cellSize * 0.61803398875f;
+
+	BeginTextureMode(atlas->target);
+	ClearBackground(COLOR_WALL);
+	DrawRectangle(DIGIT_COUNT * cellSize, 0, cellSize, cellSize, WHITE);
+	BeginRenderTextureBlendMode();
+	for (int digit = 0; digit < DIGIT_COUNT; ++digit)
+	{
+		Vector2 cellCenter = {(digit + 0.5f) * cellSize, 0.5f * cellSize};
+		Vector2 textDimensions = MeasureTextEx(font, digitTexts[digit], fontSize, 0);
+		Vector2 textCorner = Vector2Subtract(cellCenter, Vector2Scale(textDimensions, 0.5f));
+		DrawTextEx(font, digitTexts[digit], textCorner, fontSize, 0, WHITE);
+	}
+	EndBlendMode();
+	EndTextureMode();
+}
+
+Rectangle GetDigitSource(DigitAtlas *atlas, int digit)
+{
+	// Render textures are stored upside down
+	return CLITERAL(Rectangle){digit * atlas->cellSize, 0, atlas->cellSize, -atlas->cellSize};
+}
+
+// Texture coordinates of a digit cell, or of the white cell for DIGIT_COUNT.
+Rectangle GetDigitTexCoords(int cell)
+{
+	float cellWidth = 1.0f / (DIGIT_COUNT + 1);
+
+	// Render textures are stored upside down, so the top of a cell is at v = 1
+	return CLITERAL(Rectangle){cell * cellWidth, 1.0f, cellWidth, -1.0f};
+}
+
+// Push one quad into the current rlBegin(RL_QUADS) batch.
+void BatchQuad(Rectangle rect, Rectangle texCoords, Color color)
+{
+	rlColor4ub(color.r, color.g, color.b, color.a);
+
+	rlTexCoord2f(texCoords.x, texCoords.y);
+	rlVertex2f(rect.x, rect.y);
+
+	rlTexCoord2f(texCoords.x, texCoords.y + texCoords.height);
+	rlVertex2f(rect.x, rect.y + rect.height);
+
+	rlTexCoord2f(texCoords.x + texCoords.width, texCoords.y + texCoords.height);
+	rlVertex2f(rect.x + rect.width, rect.y + rect.height);
+
+	rlTexCoord2f(texCoords.x + texCoords.width, texCoords.y);
+	rlVertex2f(rect.x + rect.width, rect.y);
+}
+
+void DrawTileWithAlpha(Tile tile, int tileX, int tileY, DigitAtlas *digits, float alpha)
+{
+	Color color;
+	switch (tile.kind)
+	{
+		case TILE_EMPTY: return;
+		case TILE_LIT: color = COLOR_LIT; break;
+		case TILE_WALL: color = COLOR_WALL; break;
+		case TILE_LAMP: color = COLOR_LAMP; break;
+		default:
+			break;
+	}
+
+	Vector2 tileCorner = {
+		tileX * TILE_SIZE,
+		tileY * TILE_SIZE,
+	};
+
+	if (tile.kind == TILE_WALL && tile.lampRequirement >= 0 && tile.lampRequirement < DIGIT_COUNT)
+	{
+		Rectangle tileRect = {tileCorner.x, tileCorner.y, TILE_SIZE, TILE_SIZE};
+		Rectangle source = GetDigitSource(digits, tile.lampRequirement);
+		DrawTexturePro(digits->target.texture, source, tileRect, CLITERAL(Vector2){0}, 0.0f, ColorAlpha(WHITE, alpha));
+		return;
+	}
+
+	DrawRectangle(tileCorner.x, tileCorner.y, TILE_SIZE, TILE_SIZE, ColorAlpha(color, alpha));
+}
+
+bool IsTileInLevel(Level level, int tileX, int tileY)
+{
+	return tileX >= 0 && tileX < level.tileCountX
+		&& tileY >= 0 && tileY < level.tileCountY;
+}
+
+// The border is addressable too, from -1 to tileCount.
+int GetTileIndex(Level level, int tileX, int tileY)
+{
+	assert(tileX >= -1 && tileX <= level.tileCountX);
+	assert(tileY >= -1 && tileY <= level.tileCountY);
+	return (tileY + 1) * level.stride + tileX + 1;
+}
+
+bool IsTileInRect(TileRect rect, int tileX, int tileY)
+{
+	return tileX >= rect.minX && tileX < rect.maxX
+		&& tileY >= rect.minY && tileY < rect.maxY;
+}
+
+int GetTexelsPerTile(float zoom)
+{
+	int texelsPerTile = CHUNK_MIN_TEXELS_PER_TILE;
+	while (texelsPerTile < TILE_SIZE * zoom && texelsPerTile < CHUNK_MAX_TEXELS_PER_TILE)
+	{
+		texelsPerTile *= 2;
+	}
+	return texelsPerTile;
+}
+
+bool IsOverviewZoom(float zoom)
+{
+	return TILE_SIZE * zoom < OVERVIEW_MAX_PIXELS_PER_TILE;
+}
+
+void UnloadChunks(LevelRenderCache *cache)
+{
+	for (int i = 0; i < cache->loadedCount; ++i)
+	{
+		UnloadRenderTexture(cache->chunks[cache->loadedChunks[i]].target);
+	}
+	free(cache->chunks);
+	free(cache->loadedChunks);
+
+	cache->chunks = NULL;
+	cache->loadedChunks = NULL;
+	cache->loadedCount = 0;
+	cache->loadedCapacity = 0;
+}
+
+void UnloadLevelOverview(LevelOverview *overview)
+{
+	if (overview->isLoaded)
+	{
+		UnloadTexture(overview->texture);
+		UnloadImage(overview->image);
+	}
+	free(overview->dirtyMinX);
+	free(overview->dirtyMaxX);
+	*overview = CLITERAL(LevelOverview){0};
+}
+
+void InvalidateLevelOverview(LevelOverview *overview)
+{
+	for (int tileY = 0; tileY < overview->tileCountY; ++tileY)
+	{
+		overview->dirtyMinX[tileY] = 0;
+		overview->dirtyMaxX[tileY] = overview->tileCountX;
+	}
+	overview->dirtyMinY = 0;
+	overview->dirtyMaxY = overview->tileCountY;
+}
+
+// (Re)build the chunk layout when the level dimensions or the zoom bucket changed,
+// and the overview when the level dimensions changed.
+void PrepareLevelRenderCache(LevelRenderCache *cache, Level level, float zoom)
+{
+	LevelOverview *overview = &cache->overview;
+
+	if (overview->dirtyMinX == NULL
+		|| overview->tileCountX != level.tileCountX
+		|| overview->tileCountY != level.tileCountY)
+	{
+		UnloadLevelOverview(overview);
+		overview->tileCountX = level.tileCountX;
+		overview->tileCountY = level.tileCountY;
+		overview->dirtyMinX = (int *)ZK_CALLOC(level.tileCountY + 1, sizeof(*overview->dirtyMinX));
+		overview->dirtyMaxX = (int *)ZK_CALLOC(level.tileCountY + 1, sizeof(*overview->dirtyMaxX));
+		assert(overview->dirtyMinX != NULL && overview->dirtyMaxX != NULL);
+		InvalidateLevelOverview(overview);
+	}
+
+	int texelsPerTile = GetTexelsPerTile(zoom);
+
+	if (cache->chunks != NULL
+		&& cache->tileCountX == level.tileCountX
+		&& cache->tileCountY == level.tileCountY
+		&& cache->texelsPerTile == texelsPerTile)
+	{
+		return;
+	}
+
+	UnloadChunks(cache);
+
+	cache->tileCountX = level.tileCountX;
+	cache->tileCountY = level.tileCountY;
+	cache->texelsPerTile = texelsPerTile;
+	cache->chunkTiles = CHUNK_TEXTURE_SIZE / texelsPerTile;
+	cache->chunkCountX = (level.tileCountX + cache->chunkTiles - 1) / cache->chunkTiles;
+	cache->chunkCountY = (level.tileCountY + cache->chunkTiles - 1) / cache->chunkTiles;
+	cache->chunks = (Chunk *)ZK_CALLOC(cache->chunkCountX * cache->chunkCountY + 1, sizeof(*cache->chunks));
+	assert(cache->chunks != NULL);
+}
+
+void InvalidateTile(LevelRenderCache *cache, int tileX, int tileY)
+{
+	if (cache == NULL || cache->chunks == NULL)
+		return;
+
+	if (tileX < 0 || tileX >= cache->tileCountX || tileY < 0 || tileY >= cache->tileCountY)
+		return;
+
+	int chunkX = tileX / cache->chunkTiles;
+	int chunkY = tileY / cache->chunkTiles;
+	cache->chunks[chunkX + chunkY * cache->chunkCountX].isDirty = true;
+
+	LevelOverview *overview = &cache->overview;
+	if (tileX < overview->dirtyMinX[tileY]) overview->dirtyMinX[tileY] = tileX;
+	if (tileX >= overview->dirtyMaxX[tileY]) overview->dirtyMaxX[tileY] = tileX + 1;
+	if (tileY < overview->dirtyMinY) overview->dirtyMinY = tileY;
+	if (tileY >= overview->dirtyMaxY) overview->dirtyMaxY = tileY + 1;
+}
+
+void InvalidateTileRect(LevelRenderCache *cache, TileRect rect)
+{
+	if (cache == NULL || cache->chunks == NULL)
+		return;
+
+	if (rect.minX < 0) rect.minX = 0;
+	if (rect.minY < 0) rect.minY = 0;
+	if (rect.maxX > cache->tileCountX) rect.maxX = cache->tileCountX;
+	if (rect.maxY > cache->tileCountY) rect.maxY = cache->tileCountY;
+
+	if (rect.minX >= rect.maxX || rect.minY >= rect.maxY)
+		return;
+
+	for (int chunkY = rect.minY / cache->chunkTiles; chunkY <= (rect.maxY - 1) / cache->chunkTiles; ++chunkY)
+	{
+		for (int chunkX = rect.minX / cache->chunkTiles; chunkX <= (rect.maxX - 1) / cache->chunkTiles; ++chunkX)
+		{
+			cache->chunks[chunkX + chunkY * cache->chunkCountX].isDirty = true;
+		}
+	}
+
+	LevelOverview *overview = &cache->overview;
+	for (int tileY = rect.minY; tileY < rect.maxY; ++tileY)
+	{
+		if (rect.minX < overview->dirtyMinX[tileY]) overview->dirtyMinX[tileY] = rect.minX;
+		if (rect.maxX > overview->dirtyMaxX[tileY]) overview->dirtyMaxX[tileY] = rect.maxX;
+	}
+	if (rect.minY < overview->dirtyMinY) overview->dirtyMinY = rect.minY;
+	if (rect.maxY > overview->dirtyMaxY) overview->dirtyMaxY = rect.maxY;
+}
+
+void InvalidateLevel(LevelRenderCache *cache)
+{
+	if (cache == NULL)
+		return;
+
+	for (int i = 0; i < cache->loadedCount; ++i)
+	{
+		cache->chunks[cache->loadedChunks[i]].isDirty = true;
+	}
+
+	if (cache->overview.dirtyMinX != NULL)
+	{
+		InvalidateLevelOverview(&cache->overview);
+	}
+}
+
+Color GetTileOverviewColor(Tile tile)
+{
+	switch (tile.kind)
+	{
+		case TILE_LIT: return COLOR_LIT;
+		case TILE_WALL: return COLOR_WALL;
+		case TILE_LAMP: return COLOR_LAMP;
+		case TILE_EMPTY:
+		default:
+			return WHITE;
+	}
+}
+
+// Rewrite the out of date texels and upload the band of rows that contains them.
+void UpdateLevelOverview(LevelOverview *overview, Level level)
+{
+	if (level.tileCountX == 0 || level.tileCountY == 0)
+		return;
+
+	if (!overview->isLoaded)
+	{
+		overview->image = GenImageColor(level.tileCountX, level.tileCountY, WHITE);
+		overview->texture = LoadTextureFromImage(overview->image);
+		SetTextureWrap(overview->texture, TEXTURE_WRAP_CLAMP);
+		// One texel per tile, sharp at any zoom, so no mipmaps to keep up to date
+		SetTextureFilter(overview->texture, TEXTURE_FILTER_POINT);
+		overview->isLoaded = true;
+		InvalidateLevelOverview(overview);
+	}
+
+	if (overview->dirtyMinY >= overview->dirtyMaxY)
+		return;
+
+	Color *pixels = (Color *)overview->image.data;
+
+	for (int tileY = overview->dirtyMinY; tileY < overview->dirtyMaxY; ++tileY)
+	{
+		Tile *row = &level.tiles[GetTileIndex(level, 0, tileY)];
+		Color *pixelRow = &pixels[tileY * level.tileCountX];
+
+		for (int tileX = overview->dirtyMinX[tileY]; tileX < overview->dirtyMaxX[tileY]; ++tileX)
+		{
+			pixelRow[tileX] = GetTileOverviewColor(row[tileX]);
+		}
+		overview->dirtyMinX[tileY] = level.tileCountX;
+		overview->dirtyMaxX[tileY] = 0;
+	}
+
+	// Full width rows are contiguous in the image, so the band uploads in one go
+	Rectangle band = {
+		0,
+		overview->dirtyMinY,
+		level.tileCountX,
+		overview->dirtyMaxY - overview->dirtyMinY,
+	};
+	UpdateTextureRec(overview->texture, band, &pixels[overview->dirtyMinY * level.tileCountX]);
+
+	overview->dirtyMinY = level.tileCountY;
+	overview->dirtyMaxY = 0;
+}
+
+void DrawLevelOverview(LevelOverview *overview)
+{
+	if (!overview->isLoaded)
+		return;
+
+	Rectangle source = {0, 0, overview->tileCountX, overview->tileCountY};
+	Rectangle dest = {0, 0, overview->tileCountX * TILE_SIZE, overview->tileCountY * TILE_SIZE};
+	DrawTexturePro(overview->texture, source, dest, CLITERAL(Vector2){0}, 0.0f, WHITE);
+}
+
+TileRect GetChunkTileRect(LevelRenderCache *cache, int chunkX, int chunkY)
+{
+	TileRect rect = {
+		.minX = chunkX * cache->chunkTiles,
+		.minY = chunkY * cache->chunkTiles,
+		.maxX = (chunkX + 1) * cache->chunkTiles,
+		.maxY = (chunkY + 1) * cache->chunkTiles,
+	};
+
+	if (rect.maxX > cache->tileCountX) rect.maxX = cache->tileCountX;
+	if (rect.maxY > cache->tileCountY) rect.maxY = cache->tileCountY;
+
+	return rect;
+}
+
+// Background, grid lines and tiles all sample the digit atlas, so a whole
+// region goes out as a single batch and a single draw call.
+// lineThick is the world space width of one target pixel.
+void BatchTileGrid(Level level, DigitAtlas *digits, TileRect tiles, float lineThick)
+{
+	int tileCountX = tiles.maxX - tiles.minX;
+	int tileCountY = tiles.maxY - tiles.minY;
+	int quadCount = 1 + (tileCountX + 1) + (tileCountY + 1) + tileCountX * tileCountY;
+
+	Rectangle white = GetDigitTexCoords(DIGIT_COUNT);
+	white.x += 0.5f * white.width;
+	white.y += 0.5f * white.height;
+	white.width = 0;
+	white.height = 0;
+
+	float top = tiles.minY * TILE_SIZE;
+	float left = tiles.minX * TILE_SIZE;
+
+	// Flush up front rather than part way through the region
+	rlCheckRenderBatchLimit(4 * quadCount);
+	rlSetTexture(digits->target.texture.id);
+	rlBegin(RL_QUADS);
+	rlNormal3f(0.0f, 0.0f, 1.0f);
+	{
+		BatchQuad(CLITERAL(Rectangle){left, top, tileCountX * TILE_SIZE, tileCountY * TILE_SIZE}, white, WHITE);
+
+		for (int i = tiles.minX; i <= tiles.maxX; ++i)
+		{
+			BatchQuad(CLITERAL(Rectangle){i * TILE_SIZE, top, lineThick, tileCountY * TILE_SIZE}, white, COLOR_GRID_LINE);
+		}
+
+		for (int i = tiles.minY; i <= tiles.maxY; ++i)
+		{
+			BatchQuad(CLITERAL(Rectangle){left, i * TILE_SIZE, tileCountX * TILE_SIZE, lineThick}, white, COLOR_GRID_LINE);
+		}
+
+		for (int tileY = tiles.minY; tileY < tiles.maxY; ++tileY)
+		{
+			Tile *row = &level.tiles[GetTileIndex(level, 0, tileY)];
+
+			for (int tileX = tiles.minX; tileX < tiles.maxX; ++tileX)
 			{
-				checkTile = GetTile(level, checkX, tileY);
-				if (checkTile->kind == TILE_LAMP)
+				Tile tile = row[tileX];
+				Rectangle tileRect = {tileX * TILE_SIZE, tileY * TILE_SIZE, TILE_SIZE, TILE_SIZE};
+
+				switch (tile.kind)
 				{
-					if (violations == NULL)
+					case TILE_LIT: BatchQuad(tileRect, white, COLOR_LIT); break;
+					case TILE_LAMP: BatchQuad(tileRect, white, COLOR_LAMP); break;
+					case TILE_WALL:
 					{
-						return true;
-					}
+						if (tile.lampRequirement >= 0 && tile.lampRequirement < DIGIT_COUNT)
+						{
+							BatchQuad(tileRect, GetDigitTexCoords(tile.lampRequirement), WHITE);
+						}
+						else
+						{
+							BatchQuad(tileRect, white, COLOR_WALL);
+						}
+					} break;
+
+					case TILE_EMPTY:
+					default:
+						break;
+				}
+			}
+		}
+	}
+	rlEnd();
+	rlSetTexture(0);
+}
+
+void RenderChunk(LevelRenderCache *cache, int chunkX, int chunkY, Level level, DigitAtlas *digits)
+{
+	Chunk *chunk = &cache->chunks[chunkX + chunkY * cache->chunkCountX];
+	TileRect tiles = GetChunkTileRect(cache, chunkX, chunkY);
+
+	Camera2D chunkCamera = {
+		.target = {
+			chunkX * cache->chunkTiles * TILE_SIZE,
+			chunkY * cache->chunkTiles * TILE_SIZE,
+		},
+		.zoom = (float)cache->texelsPerTile / TILE_SIZE,
+	};
+
+	BeginTextureMode(chunk->target);
+	ClearBackground(BLANK);
+	BeginRenderTextureBlendMode();
+	BeginMode2D(chunkCamera);
+	{
+		BatchTileGrid(level, digits, tiles, 1.0f / chunkCamera.zoom);
+	}
+	EndMode2D();
+	EndBlendMode();
+	EndTextureMode();
+
+	chunk->isDirty = false;
+}
+
+// Load and re-render the chunks in view that are missing or dirty, and evict
+// the ones that have been out of view for a while.
+// Must be called outside of BeginMode2D, as chunks are rendered in texture mode.
+void UpdateLevelRenderCache(LevelRenderCache *cache, Level level, DigitAtlas *digits, TileRect visible)
+{
+	++cache->frame;
+
+	if (visible.minX < visible.maxX && visible.minY < visible.maxY)
+	{
+		int chunkMinX = visible.minX / cache->chunkTiles;
+		int chunkMinY = visible.minY / cache->chunkTiles;
+		int chunkMaxX = (visible.maxX - 1) / cache->chunkTiles;
+		int chunkMaxY = (visible.maxY - 1) / cache->chunkTiles;
+
+		for (int chunkY = chunkMinY; chunkY <= chunkMaxY; ++chunkY)
+		{
+			for (int chunkX = chunkMinX; chunkX <= chunkMaxX; ++chunkX)
+			{
+				int chunkIndex = chunkX + chunkY * cache->chunkCountX;
+				Chunk *chunk = &cache->chunks[chunkIndex];
+
+				if (!chunk->isLoaded)
+				{
+					chunk->target = LoadRenderTexture(CHUNK_TEXTURE_SIZE, CHUNK_TEXTURE_SIZE);
+					SetTextureFilter(chunk->target.texture, TEXTURE_FILTER_BILINEAR);
+					SetTextureWrap(chunk->target.texture, TEXTURE_WRAP_CLAMP);
+					chunk->isLoaded = true;
+					chunk->isDirty = true;
+
+					if (cache->loadedCount == cache->loadedCapacity)
+					{
+						cache->loadedCapacity = cache->loadedCapacity ? 2 * cache->loadedCapacity : 64;
+						cache->loadedChunks = ZK_REALLOC(cache->loadedChunks, sizeof(cache->loadedChunks[0]) * cache->loadedCapacity);
+						assert(cache->loadedChunks != NULL);
+					}
+					cache->loadedChunks[cache->loadedCount++] = chunkIndex;
+				}
+
+				if (chunk->isDirty)
+				{
+					RenderChunk(cache, chunkX, chunkY, level, digits);
+				}
+
+				chunk->lastUsedFrame = cache->frame;
+			}
+		}
+	}
+
+	for (int i = 0; i < cache->loadedCount;)
+	{
+		Chunk *chunk = &cache->chunks[cache->loadedChunks[i]];
+		if (cache->frame - chunk->lastUsedFrame > CHUNK_EVICT_AFTER_FRAMES)
+		{
+			UnloadRenderTexture(chunk->target);
+			chunk->isLoaded = false;
+			cache->loadedChunks[i] = cache->loadedChunks[--cache->loadedCount];
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void DrawLevelRenderCache(LevelRenderCache *cache, TileRect visible)
+{
+	if (visible.minX >= visible.maxX || visible.minY >= visible.maxY)
+		return;
+
+	int chunkMinX = visible.minX / cache->chunkTiles;
+	int chunkMinY = visible.minY / cache->chunkTiles;
+	int chunkMaxX = (visible.maxX - 1) / cache->chunkTiles;
+	int chunkMaxY = (visible.maxY - 1) / cache->chunkTiles;
+
+	float chunkWorldSize = cache->chunkTiles * TILE_SIZE;
+
+	for (int chunkY = chunkMinY; chunkY <= chunkMaxY; ++chunkY)
+	{
+		for (int chunkX = chunkMinX; chunkX <= chunkMaxX; ++chunkX)
+		{
+			Chunk *chunk = &cache->chunks[chunkX + chunkY * cache->chunkCountX];
+			if (!chunk->isLoaded)
+				continue;
+
+			// Render textures are stored upside down
+			Rectangle source = {0, 0, CHUNK_TEXTURE_SIZE, -CHUNK_TEXTURE_SIZE};
+			Rectangle dest = {chunkX * chunkWorldSize, chunkY * chunkWorldSize, chunkWorldSize, chunkWorldSize};
+			DrawTexturePro(chunk->target.texture, source, dest, CLITERAL(Vector2){0}, 0.0f, WHITE);
+		}
+	}
+}
+
+void TileFromVector2(Vector2 worldPosition, int *tileX, int *tileY)
+{
+	*tileX = worldPosition.x / TILE_SIZE;
+	*tileY = worldPosition.y / TILE_SIZE;
+	if (worldPosition.x < 0) --*tileX;
+	if (worldPosition.y < 0) --*tileY;
+}
+
+Vector2 GetMouseWorldPosition(Camera2D camera)
+{
+	return GetScreenToWorld2D(GetMousePosition(), camera);
+}
+
+void GetMouseTile(Camera2D camera, int *mouseTileX, int *mouseTileY)
+{
+	Vector2 worldPosition = GetMouseWorldPosition(camera);
+	TileFromVector2(worldPosition, mouseTileX, mouseTileY);
+}
+
+// The tiles of the level that touch the viewport, so drawing cost follows
+// the screen area instead of the level size.
+TileRect GetVisibleTileRect(Camera2D camera, Level level)
+{
+	Vector2 corners[4] = {
+		GetScreenToWorld2D(CLITERAL(Vector2){0, 0}, camera),
+		GetScreenToWorld2D(CLITERAL(Vector2){GetRenderWidth(), 0}, camera),
+		GetScreenToWorld2D(CLITERAL(Vector2){0, GetRenderHeight()}, camera),
+		GetScreenToWorld2D(CLITERAL(Vector2){GetRenderWidth(), GetRenderHeight()}, camera),
+	};
+
+	Vector2 worldMin = corners[0];
+	Vector2 worldMax = corners[0];
+	for (int i = 1; i < 4; ++i)
+	{
+		worldMin.x = fminf(worldMin.x, corners[i].x);
+		worldMin.y = fminf(worldMin.y, corners[i].y);
+		worldMax.x = fmaxf(worldMax.x, corners[i].x);
+		worldMax.y = fmaxf(worldMax.y, corners[i].y);
+	}
+
+	TileRect visible;
+	TileFromVector2(worldMin, &visible.minX, &visible.minY);
+	TileFromVector2(worldMax, &visible.maxX, &visible.maxY);
+	++visible.maxX;
+	++visible.maxY;
+
+	visible.minX = Clamp(visible.minX, 0, level.tileCountX);
+	visible.minY = Clamp(visible.minY, 0, level.tileCountY);
+	visible.maxX = Clamp(visible.maxX, 0, level.tileCountX);
+	visible.maxY = Clamp(visible.maxY, 0, level.tileCountY);
+
+	return visible;
+}
+
+void DrawTileOutline(int tileX, int tileY, float thick, Color color)
+{
+	Rectangle tileRect = {
+		tileX,
+		tileY,
+		TILE_SIZE,
+		TILE_SIZE,
+	};
+
+	DrawRectangleLinesEx(tileRect, thick, color);
+}
+
+TileRect GetSelectionRect(Editor *editor)
+{
+	TileRect rect = {
+		.minX = editor->selectionStartX < editor->selectionEndX ? editor->selectionStartX : editor->selectionEndX,
+		.minY = editor->selectionStartY < editor->selectionEndY ? editor->selectionStartY : editor->selectionEndY,
+		.maxX = editor->selectionStartX > editor->selectionEndX ? editor->selectionStartX : editor->selectionEndX,
+		.maxY = editor->selectionStartY > editor->selectionEndY ? editor->selectionStartY : editor->selectionEndY,
+	};
+	++rect.maxX;
+	++rect.maxY;
+	return rect;
+}
+
+void DrawSelection(Editor *editor)
+{
+	TileRect selection = GetSelectionRect(editor);
+	Rectangle selectionRect = {
+		selection.minX * TILE_SIZE,
+		selection.minY * TILE_SIZE,
+		(selection.maxX - selection.minX) * TILE_SIZE,
+		(selection.maxY - selection.minY) * TILE_SIZE,
+	};
+
+	Color color = editor->isSelectionClear ? RED : COLOR_WALL;
+	DrawRectangleRec(selectionRect, ColorAlpha(color, 0.25f));
+	DrawRectangleLinesEx(selectionRect, 2.0f / editor->camera.zoom, color);
+}
+
+void DrawTileCursor(Editor *editor)
+{
+	int mouseTileX;
+	int mouseTileY;
+	GetMouseTile(editor->camera, &mouseTileX, &mouseTileY);
+
+	Vector2 tilePosition = {mouseTileX * TILE_SIZE, mouseTileY * TILE_SIZE};
+
+	if (editor->tileToDraw.kind == TILE_EMPTY)
+	{
+		DrawLineEx(
+			CLITERAL(Vector2){mouseTileX * TILE_SIZE, mouseTileY * TILE_SIZE},
+			CLITERAL(Vector2){(mouseTileX + 1) * TILE_SIZE, (mouseTileY + 1) * TILE_SIZE},
+			3.0f,
+			RED);
+		DrawLineEx(
+			CLITERAL(Vector2){mouseTileX * TILE_SIZE, (mouseTileY + 1) * TILE_SIZE},
+			CLITERAL(Vector2){(mouseTileX + 1) * TILE_SIZE, mouseTileY * TILE_SIZE},
+			3.0f,
+			RED);		
+	}
+	else
+	{
+		DrawTileWithAlpha(editor->tileToDraw, mouseTileX, mouseTileY, &editor->digits, 0.4f);
+		DrawTileOutline(tilePosition.x, tilePosition.y, 4, ColorAlpha(WHITE, 0.5f));
+	}
+}
+
+Tile *GetTile(Level level, int tileX, int tileY)
+{
+	return &level.tiles[GetTileIndex(level, tileX, tileY)];
+}
+
+bool TryGetTile(Level level, int tileX, int tileY, Tile **outTile)
+{
+	if (!IsTileInLevel(level, tileX, tileY))
+	{
+		return false;
+	}
+	
+	*outTile = GetTile(level, tileX, tileY);
+	return true;
+}
+
+// Tiles in use, border included.
+size_t GetLevelTileStorageCount(Level level)
+{
+	return (size_t)level.stride * (level.tileCountY + 2);
+}
+
+void SetLevelBorder(Level level)
+{
+	Tile wall = {TILE_WALL, .lampRequirement = -1};
+
+	for (int tileX = -1; tileX <= level.tileCountX; ++tileX)
+	{
+		*GetTile(level, tileX, -1) = wall;
+		*GetTile(level, tileX, level.tileCountY) = wall;
+	}
+
+	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	{
+		*GetTile(level, -1, tileY) = wall;
+		*GetTile(level, level.tileCountX, tileY) = wall;
+	}
+}
+
+// Empty tiles inside a border of walls, without slack.
+Level CreateLevel(int tileCountX, int tileCountY)
+{
+	Level level = {
+		.tileCountX = tileCountX,
+		.tileCountY = tileCountY,
+		.stride = tileCountX + 2,
+		.capacityY = tileCountY + 2,
+	};
+	level.tiles = (Tile *)ZK_CALLOC((size_t)level.stride * level.capacityY, sizeof(*level.tiles));
+	assert(level.tiles != NULL);
+
+	SetLevelBorder(level);
+	return level;
+}
+
+// Keeps the tiles that still fit. Resizes in place when the slack allows,
+// otherwise reallocates with half again as much slack for the next time.
+void ResizeLevel(Level *level, int tileCountX, int tileCountY)
+{
+	if (tileCountX + 2 <= level->stride && tileCountY + 2 <= level->capacityY)
+	{
+		Level resized = *level;
+		resized.tileCountX = tileCountX;
+		resized.tileCountY = tileCountY;
+
+		// Uncovered tiles held the old border or tiles from before a shrink
+		for (int tileY = 0; tileY < tileCountY; ++tileY)
+		{
+			int firstNewX = (tileY < level->tileCountY) ? level->tileCountX : 0;
+			for (int tileX = firstNewX; tileX < tileCountX; ++tileX)
+			{
+				*GetTile(resized, tileX, tileY) = CLITERAL(Tile){TILE_EMPTY};
+			}
+		}
+
+		SetLevelBorder(resized);
+		*level = resized;
+		return;
+	}
+
+	Level resized = {
+		.tileCountX = tileCountX,
+		.tileCountY = tileCountY,
+		.stride = tileCountX + 2 + tileCountX / 2,
+		.capacityY = tileCountY + 2 + tileCountY / 2,
+	};
+	resized.tiles = (Tile *)ZK_CALLOC((size_t)resized.stride * resized.capacityY, sizeof(*resized.tiles));
+	assert(resized.tiles != NULL);
+
+	int keptCountX = tileCountX < level->tileCountX ? tileCountX : level->tileCountX;
+	int keptCountY = tileCountY < level->tileCountY ? tileCountY : level->tileCountY;
+	for (int tileY = 0; tileY < keptCountY; ++tileY)
+	{
+		memcpy(GetTile(resized, 0, tileY), GetTile(*level, 0, tileY), sizeof(Tile) * keptCountX);
+	}
+
+	SetLevelBorder(resized);
+	free(level->tiles);
+	*level = resized;
+}
+
+// Whether two tiles are the same as far as the puzzle goes, lit or not.
+bool IsSameTile(Tile a, Tile b)
+{
+	bool aIsFloor = a.kind == TILE_EMPTY || a.kind == TILE_LIT;
+	bool bIsFloor = b.kind == TILE_EMPTY || b.kind == TILE_LIT;
+
+	if (aIsFloor || bIsFloor)
+		return aIsFloor && bIsFloor;
+
+	if (a.kind != b.kind)
+		return false;
+
+	return a.kind != TILE_WALL || a.lampRequirement == b.lampRequirement;
+}
+
+// Returns whether the tile changed.
+bool PutTile(Level level, int tileX, int tileY, Tile tile, LevelRenderCache *renderCache)
+{
+	if (!IsTileInLevel(level, tileX, tileY))
+		return false;
+
+	Tile *levelTile = GetTile(level, tileX, tileY);
+	if (IsSameTile(*levelTile, tile))
+		return false;
+
+	*levelTile = tile;
+	InvalidateTile(renderCache, tileX, tileY);
+	return true;
+}
+
+// Returns whether any tile changed.
+bool FillTileRect(Level level, TileRect rect, Tile tile, LevelRenderCache *renderCache)
+{
+	if (rect.minX < 0) rect.minX = 0;
+	if (rect.minY < 0) rect.minY = 0;
+	if (rect.maxX > level.tileCountX) rect.maxX = level.tileCountX;
+	if (rect.maxY > level.tileCountY) rect.maxY = level.tileCountY;
+
+	if (rect.minX >= rect.maxX || rect.minY >= rect.maxY)
+		return false;
+
+	bool changed = false;
+
+	for (int tileY = rect.minY; tileY < rect.maxY; ++tileY)
+	{
+		Tile *row = GetTile(level, rect.minX, tileY);
+		for (int i = 0; i < rect.maxX - rect.minX; ++i)
+		{
+			// Lit floor stays lit when filled with floor
+			if (!IsSameTile(row[i], tile))
+			{
+				row[i] = tile;
+				changed = true;
+			}
+		}
+	}
+
+	if (changed)
+	{
+		InvalidateTileRect(renderCache, rect);
+	}
+
+	return changed;
+}
+
+typedef struct TileSeed
+{
+	int tileX;
+	int tileY;
+} TileSeed;
+
+// Scanline flood fill of the region of tiles that are the same as the start tile.
+// Returns whether any tile changed.
+bool FloodFillTiles(Level level, int startX, int startY, Tile tile, LevelRenderCache *renderCache)
+{
+	if (!IsTileInLevel(level, startX, startY))
+		return false;
+
+	Tile region = *GetTile(level, startX, startY);
+
+	// Filled tiles must stop matching the region, or the fill would never end
+	if (IsSameTile(region, tile))
+		return false;
+
+	int seedCapacity = 64;
+	int seedCount = 0;
+	TileSeed *seeds = (TileSeed *)ZK_MALLOC(sizeof(*seeds) * seedCapacity);
+	assert(seeds != NULL);
+
+	seeds[seedCount++] = CLITERAL(TileSeed){startX, startY};
+
+	while (seedCount > 0)
+	{
+		TileSeed seed = seeds[--seedCount];
+		Tile *row = GetTile(level, 0, seed.tileY);
+
+		if (!IsSameTile(row[seed.tileX], region))
+			continue;
+
+		int minX = seed.tileX;
+		int maxX = seed.tileX + 1;
+		while (minX > 0 && IsSameTile(row[minX - 1], region)) --minX;
+		while (maxX < level.tileCountX && IsSameTile(row[maxX], region)) ++maxX;
+
+		for (int tileX = minX; tileX < maxX; ++tileX)
+		{
+			row[tileX] = tile;
+		}
+		InvalidateTileRect(renderCache, CLITERAL(TileRect){minX, seed.tileY, maxX, seed.tileY + 1});
+
+		for (int neighborY = seed.tileY - 1; neighborY <= seed.tileY + 1; neighborY += 2)
+		{
+			if (neighborY < 0 || neighborY >= level.tileCountY)
+				continue;
+
+			Tile *neighborRow = GetTile(level, 0, neighborY);
+
+			// One seed per run of matching tiles
+			for (int tileX = minX; tileX < maxX; ++tileX)
+			{
+				if (!IsSameTile(neighborRow[tileX], region))
+					continue;
+
+				if (tileX > minX && IsSameTile(neighborRow[tileX - 1], region))
+					continue;
+
+				if (seedCount == seedCapacity)
+				{
+					seedCapacity *= 2;
+					seeds = (TileSeed *)ZK_REALLOC(seeds, sizeof(*seeds) * seedCapacity);
+					assert(seeds != NULL);
+				}
+				seeds[seedCount++] = CLITERAL(TileSeed){tileX, neighborY};
+			}
+		}
+	}
+
+	free(seeds);
+	return true;
+}
+
+void ReserveViolations(Violations *violations, int capacity)
+{
+	if (capacity <= violations->capacity)
+	{
+		return;
+	}
+
+	if (violations->arena == NULL)
+	{
+		violations->items = ZK_REALLOC(violations->items, sizeof(violations->items[0]) * capacity);
+		assert(violations->items != NULL);
+	}
+	else
+	{
+		// The old items stay behind in the arena until it is reset
+		Violation *items = (Violation *)ArenaAlloc(violations->arena, sizeof(items[0]) * capacity);
+		if (violations->count > 0)
+		{
+			memcpy(items, violations->items, sizeof(items[0]) * violations->count);
+		}
+		violations->items = items;
+	}
+	violations->capacity = capacity;
+}
+
+void AddViolation(Violations *violations, Violation violation)
+{
+	if (violations->count == violations->capacity)
+	{
+		ReserveViolations(violations, violations->capacity ? 2 * violations->capacity : 8);
+	}
+
+	violations->items[violations->count] = violation;
+	++violations->count;
+}
+
+void AppendViolations(Violations *violations, Violations other)
+{
+	ReserveViolations(violations, violations->count + other.count);
+
+	if (other.count > 0)
+	{
+		memcpy(&violations->items[violations->count], other.items, sizeof(other.items[0]) * other.count);
+		violations->count += other.count;
+	}
+}
+
+// The checks below cover a range of rows or columns, so the whole level can be
+// split over threads. With violations NULL they stop at the first violation.
+
+// Neighbors outside the level are border walls, never lamps.
+int CountNeighborLamps(Level level, int tileX, int tileY)
+{
+	Tile *tile = GetTile(level, tileX, tileY);
+
+	return (tile[-1].kind == TILE_LAMP)
+		+ (tile[1].kind == TILE_LAMP)
+		+ (tile[-level.stride].kind == TILE_LAMP)
+		+ (tile[level.stride].kind == TILE_LAMP);
+}
+
+bool GetLampRequirementViolationsInRows(Level level, int beginY, int endY, Violations *violations)
+{
+	bool foundViolation = false;
+
+	for (int tileY = beginY; tileY < endY; ++tileY)
+	{
+		Tile *row = GetTile(level, 0, tileY);
+
+		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
+		{
+			Tile tile = row[tileX];
+			if (tile.kind != TILE_WALL)
+			{
+				continue;
+			}
+
+			if (tile.lampRequirement == -1)
+				continue;
+
+			// tile is a wall
+			if (CountNeighborLamps(level, tileX, tileY) != tile.lampRequirement)
+			{
+				if (violations == NULL)
+				{
+					return true;
+				}
+
+				foundViolation = true;
+				AddViolation(violations, CLITERAL(Violation){
+					.kind = VIOLATION_LAMP_REQUIREMENT,
+					.tileX = tileX,
+					.tileY = tileY,
+				});
+			}
+		}
+	}
+	return foundViolation;
+}
+
+// Lamps that see each other along a row, reported in pairs of neighbors.
+bool GetLampPairViolationsInRows(Level level, int beginY, int endY, Violations *violations)
+{
+	bool foundViolation = false;
+
+	for (int tileY = beginY; tileY < endY; ++tileY)
+	{
+		int lastLampX = -1;
+		Tile *row = GetTile(level, 0, tileY);
+
+		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
+		{
+			TileKind kind = row[tileX].kind;
+
+			if (kind == TILE_WALL)
+			{
+				lastLampX = -1;
+			}
+			else if (kind == TILE_LAMP)
+			{
+				if (lastLampX >= 0)
+				{
+					if (violations == NULL)
+					{
+						return true;
+					}
+
+					foundViolation = true;
+					AddViolation(violations, CLITERAL(Violation){
+						.kind = VIOLATION_LAMP_LIT_BY_OTHER_LAMP,
+						.tileX = lastLampX,
+						.tileY = tileY,
+					});
+					AddViolation(violations, CLITERAL(Violation){
+						.kind = VIOLATION_LAMP_LIT_BY_OTHER_LAMP,
+						.tileX = tileX,
+						.tileY = tileY,
+					});
+				}
+				lastLampX = tileX;
+			}
+		}
+	}
+	return foundViolation;
+}
+
+// Like GetLampPairViolationsInRows, for columns [beginX, endX). Walks the
+// block row by row to stay cache friendly.
+bool GetLampPairViolationsInColumns(Level level, int beginX, int endX, Violations *violations)
+{
+	bool foundViolation = false;
+
+	int *lastLampY = (int *)ZK_MALLOC(sizeof(*lastLampY) * (endX - beginX + 1));
+	assert(lastLampY != NULL);
+	for (int i = 0; i < endX - beginX; ++i)
+	{
+		lastLampY[i] = -1;
+	}
+
+	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	{
+		Tile *row = GetTile(level, 0, tileY);
+
+		for (int tileX = beginX; tileX < endX; ++tileX)
+		{
+			TileKind kind = row[tileX].kind;
+			int *columnLastLampY = &lastLampY[tileX - beginX];
+
+			if (kind == TILE_WALL)
+			{
+				*columnLastLampY = -1;
+			}
+			else if (kind == TILE_LAMP)
+			{
+				if (*columnLastLampY >= 0)
+				{
+					foundViolation = true;
+					if (violations == NULL)
+					{
+						goto Done;
+					}
+
+					AddViolation(violations, CLITERAL(Violation){
+						.kind = VIOLATION_LAMP_LIT_BY_OTHER_LAMP,
+						.tileX = tileX,
+						.tileY = *columnLastLampY,
+					});
+					AddViolation(violations, CLITERAL(Violation){
+						.kind = VIOLATION_LAMP_LIT_BY_OTHER_LAMP,
+						.tileX = tileX,
+						.tileY = tileY,
+					});
+				}
+				*columnLastLampY = tileY;
+			}
+		}
+	}
+
+Done:
+	free(lastLampY);
+	return foundViolation;
+}
+
+bool GetLampRequirementViolations(Level level, Violations *violations)
+{
+	return GetLampRequirementViolationsInRows(level, 0, level.tileCountY, violations);
+}
+
+bool GetLampLitByOtherLampViolations(Level level, Violations *violations)
+{
+	bool foundViolation = GetLampPairViolationsInRows(level, 0, level.tileCountY, violations);
+
+	if (foundViolation && violations == NULL)
+	{
+		return true;
+	}
+
+	foundViolation |= GetLampPairViolationsInColumns(level, 0, level.tileCountX, violations);
+	return foundViolation;
+}
+
+typedef struct ViolationPass
+{
+	Level level;
+	Violations *taskViolations;
+} ViolationPass;
+
+void GetViolationsInRowsTask(void *data, int task, int begin, int end)
+{
+	ViolationPass *pass = (ViolationPass *)data;
+	GetLampRequirementViolationsInRows(pass->level, begin, end, &pass->taskViolations[task]);
+	GetLampPairViolationsInRows(pass->level, begin, end, &pass->taskViolations[task]);
+}
+
+void GetViolationsInColumnsTask(void *data, int task, int begin, int end)
+{
+	ViolationPass *pass = (ViolationPass *)data;
+	GetLampPairViolationsInColumns(pass->level, begin, end, &pass->taskViolations[task]);
+}
+
+// Rows and columns split over the job system, every task collects into its
+// own buffer and the buffers are merged in task order at the end.
+void GetViolationsParallel(Level level, Violations *violations, JobSystem *jobs)
+{
+	int tileCount = level.tileCountX * level.tileCountY;
+	int rowTaskCount = GetParallelTaskCount(jobs, level.tileCountY, tileCount);
+	int columnTaskCount = GetParallelTaskCount(jobs, level.tileCountX, tileCount);
+	int taskCount = rowTaskCount + columnTaskCount;
+
+	ViolationPass pass = {
+		.level = level,
+		.taskViolations = (Violations *)ZK_CALLOC(taskCount, sizeof(Violations)),
+	};
+	assert(pass.taskViolations != NULL);
+
+	ParallelFor(jobs, level.tileCountY, rowTaskCount, GetViolationsInRowsTask, &pass);
+
+	pass.taskViolations += rowTaskCount;
+	ParallelFor(jobs, level.tileCountX, columnTaskCount, GetViolationsInColumnsTask, &pass);
+	pass.taskViolations -= rowTaskCount;
+
+	// Reserved once, an arena backed list would otherwise leave a block behind per task
+	int count = violations->count;
+	for (int task = 0; task < taskCount; ++task)
+	{
+		count += pass.taskViolations[task].count;
+	}
+	ReserveViolations(violations, count);
+
+	for (int task = 0; task < taskCount; ++task)
+	{
+		AppendViolations(violations, pass.taskViolations[task]);
+		free(pass.taskViolations[task].items);
+	}
+	free(pass.taskViolations);
+}
+
+int CompareViolations(const void *a, const void *b)
+{
+	const Violation *left = (const Violation *)a;
+	const Violation *right = (const Violation *)b;
+
+	if (left->tileY != right->tileY)
+		return left->tileY - right->tileY;
+	if (left->tileX != right->tileX)
+		return left->tileX - right->tileX;
+	return (int)left->kind - (int)right->kind;
+}
+
+// Lamps between two others, or paired along both their row and column, come
+// out of the pair checks more than once. Keeps one violation per tile and kind
+// from begin on, the same list UpdateViolationsAround builds.
+void RemoveDuplicateViolations(Violations *violations, int begin)
+{
+	if (violations->count - begin < 2)
+		return;
+
+	Violation *items = &violations->items[begin];
+	int itemCount = violations->count - begin;
+	qsort(items, itemCount, sizeof(items[0]), CompareViolations);
+
+	int count = 1;
+	for (int i = 1; i < itemCount; ++i)
+	{
+		if (CompareViolations(&items[count - 1], &items[i]) != 0)
+		{
+			items[count++] = items[i];
+		}
+	}
+	violations->count = begin + count;
+}
+
+// jobs may be NULL, then everything runs on the calling thread.
+bool GetViolations(Level level, Violations *violations, JobSystem *jobs)
+{
+	if (violations != NULL && GetParallelTaskCount(jobs, level.tileCountY, level.tileCountX * level.tileCountY) > 1)
+	{
+		int count = violations->count;
+		GetViolationsParallel(level, violations, jobs);
+		RemoveDuplicateViolations(violations, count);
+		return violations->count > count;
+	}
+
+	bool foundViolation = false;
+	int count = violations != NULL ? violations->count : 0;
+
+	// For all wall tiles,
+	//   if lamp requirement, check neighbor tiles for correct amount of lamps
+	foundViolation |= GetLampRequirementViolations(level, violations);
+	
+	// For all lamp tiles,
+	//   Check that they are not lit by another lamp
+	foundViolation |= GetLampLitByOtherLampViolations(level, violations);
+
+	if (violations != NULL)
+	{
+		RemoveDuplicateViolations(violations, count);
+	}
+
+	// If any ground tiles are not lit,
+	//   We have not completed the puzzle
+	return foundViolation;
+}
+
+Vector2 WorldCoordinateFromTile(int tileX, int tileY)
+{
+	return (Vector2){
+		tileX * TILE_SIZE,
+		tileY * TILE_SIZE,
+	};
+}
+
+void DrawViolations(Violations *violations, TileRect visible)
+{
+	for (int i = 0; i < violations->count; ++i)
+	{
+		Violation violation = violations->items[i];
+		assert(violation.kind == VIOLATION_LAMP_REQUIREMENT || violation.kind == VIOLATION_LAMP_LIT_BY_OTHER_LAMP);
+
+		if (!IsTileInRect(visible, violation.tileX, violation.tileY))
+		{
+			continue;
+		}
+
+		Vector2 tileCoord = WorldCoordinateFromTile(violation.tileX, violation.tileY);
+
+		DrawTileOutline(tileCoord.x, tileCoord.y, 4, RED);
+	}
+}
+
+// Lamps placed inside open branches get an overlay, so they stand apart from
+// the committed ones.
+void DrawBranchLamps(Branches *branches, Level level, TileRect visible)
+{
+	for (int i = 0; i < branches->count; ++i)
+	{
+		BranchDelta delta = branches->deltas[i];
+
+		if (!IsTileInRect(visible, delta.tileX, delta.tileY) || GetTile(level, delta.tileX, delta.tileY)->kind != TILE_LAMP)
+			continue;
+
+		Rectangle tileRect = {
+			delta.tileX * TILE_SIZE,
+			delta.tileY * TILE_SIZE,
+			TILE_SIZE,
+			TILE_SIZE,
+		};
+		DrawRectangleRec(tileRect, ColorAlpha(COLOR_BRANCH_LAMP, 0.5f));
+	}
+}
+
+int CountUnlitTiles(Level level)
+{
+	int count = 0;
+
+	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	{
+		Tile *row = GetTile(level, 0, tileY);
+		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
+		{
+			count += (row[tileX].kind == TILE_EMPTY);
+		}
+	}
+
+	return count;
+}
+
+bool HasUnlitTiles(Level level)
+{
+	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	{
+		Tile *row = GetTile(level, 0, tileY);
+		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
+		{
+			if (row[tileX].kind == TILE_EMPTY)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void DrawDebugInfo(Editor *editor)
+{
+	Rectangle debugTextBounds = {
+		0.0f,
+		0.0f,
+		400.0f,
+		GetRenderHeight(),
+	};
+	DrawRectangleRec(debugTextBounds, (Color){255,255,255,160});
+	float fontSize = 24.0f;
+	float fontSpacing = 1.0f;
+	float pad = 20.0f;
+	Vector2 textPos = {pad, pad};
+	const char *text = ArenaFormat(&editor->frameArena, "Zoom: %d%%", (int)(editor->camera.zoom*100.0f));
+	Vector2 textDimensions = MeasureTextEx(editor->font, text, fontSize, fontSpacing);
+	DrawTextEx(editor->font, text, textPos, fontSize, fontSpacing, BLACK);
+	textPos.y += textDimensions.y * 1.618034f;
+	int mouseTileX, mouseTileY;
+	GetMouseTile(editor->camera, &mouseTileX, &mouseTileY);
+	text = ArenaFormat(&editor->frameArena, "Cursor Position: (%d, %d)", mouseTileX, mouseTileY);
+	DrawTextEx(editor->font, text, textPos, fontSize, fontSpacing, BLACK);
+	textPos.y += textDimensions.y * 1.618034f;
+	text = ArenaFormat(&editor->frameArena, "Open Branches: %d", editor->branches.markCount);
+	DrawTextEx(editor->font, text, textPos, fontSize, fontSpacing, BLACK);
+	textPos.y += textDimensions.y * 1.618034f;
+	text = ArenaFormat(&editor->frameArena, "Heap Allocations Last Frame: %d", editor->lastFrameHeapAllocationCount);
+	DrawTextEx(editor->font, text, textPos, fontSize, fontSpacing, BLACK);
+	textPos.y += textDimensions.y * 1.618034f;
+	text = ArenaFormat(&editor->frameArena, "Frame Arena: %d / %d KiB",
+		(int)(editor->frameArena.requested / 1024), (int)(editor->frameArena.capacity / 1024));
+	DrawTextEx(editor->font, text, textPos, fontSize, fontSpacing, BLACK);
+	textPos.y += textDimensions.y * 1.618034f;
+	text = ArenaFormat(&editor->frameArena, "Level Arena: %d / %d KiB",
+		(int)(editor->levelArena.requested / 1024), (int)(editor->levelArena.capacity / 1024));
+	DrawTextEx(editor->font, text, textPos, fontSize, fontSpacing, BLACK);
+}
+
+bool IsWorkspaceOpen(Workspace *workspace)
+{
+	return workspace->count > 0;
+}
+
+Rectangle GetSelectorBounds(void)
+{
+	return CLITERAL(Rectangle){
+		0.0f,
+		GetRenderHeight() - SELECTOR_HEIGHT,
+		GetRenderWidth(),
+		SELECTOR_HEIGHT,
+	};
+}
+
+// The entries [*first, *end) fit in the selector strip, around the active one.
+void GetSelectorRange(Workspace *workspace, int *first, int *end)
+{
+	int slotCount = GetRenderWidth() / SELECTOR_SLOT_WIDTH + 1;
+	int start = workspace->active - slotCount / 2;
+
+	if (start > workspace->count - slotCount) start = workspace->count - slotCount;
+	if (start < 0) start = 0;
+
+	*first = start;
+	*end = (start + slotCount < workspace->count) ? start + slotCount : workspace->count;
+}
+
+Rectangle GetSelectorThumbnailRect(int slot)
+{
+	return CLITERAL(Rectangle){
+		slot * SELECTOR_SLOT_WIDTH + SELECTOR_PAD,
+		GetRenderHeight() - SELECTOR_HEIGHT + SELECTOR_PAD,
+		THUMBNAIL_SIZE,
+		THUMBNAIL_SIZE,
+	};
+}
+
+void DrawWorkspaceSelector(Editor *editor)
+{
+	Workspace *workspace = &editor->workspace;
+
+	DrawRectangleRec(GetSelectorBounds(), (Color){255,255,255,200});
+
+	int first, end;
+	GetSelectorRange(workspace, &first, &end);
+
+	for (int index = first; index < end; ++index)
+	{
+		WorkspaceEntry *entry = &workspace->entries[index];
+		Rectangle thumbnailRect = GetSelectorThumbnailRect(index - first);
+
+		if (entry->thumbnail.id != 0)
+		{
+			DrawTextureV(entry->thumbnail, CLITERAL(Vector2){thumbnailRect.x, thumbnailRect.y}, WHITE);
+		}
+		else if (entry->tileCountX > 0 && entry->tileCountY > 0)
+		{
+			// Until the thumbnail arrives, show the shape of the level from the index
+			float scale = THUMBNAIL_SIZE / (float)(entry->tileCountX > entry->tileCountY ? entry->tileCountX : entry->tileCountY);
+			Rectangle placeholder = {0, 0, entry->tileCountX * scale, entry->tileCountY * scale};
+			placeholder.x = thumbnailRect.x + 0.5f * (THUMBNAIL_SIZE - placeholder.width);
+			placeholder.y = thumbnailRect.y + 0.5f * (THUMBNAIL_SIZE - placeholder.height);
+			DrawRectangleRec(thumbnailRect, COLOR_BACKGROUND);
+			DrawRectangleRec(placeholder, WHITE);
+		}
+
+		if (index == workspace->active)
+		{
+			DrawRectangleLinesEx(thumbnailRect, 3.0f, COLOR_WALL);
+		}
+
+		// Unsaved levels are marked with a star
+		const char *name = ArenaFormat(&editor->frameArena, "%s%s", entry->isModified ? "*" : "", GetFileNameWithoutExt(entry->source.path));
+		if (entry->source.pack != NULL)
+		{
+			name = ArenaFormat(&editor->frameArena, "%s #%d", name, entry->source.packIndex + 1);
+		}
+		Vector2 namePosition = {thumbnailRect.x, thumbnailRect.y + thumbnailRect.height + 2.0f};
+		BeginScissorMode(namePosition.x, namePosition.y, thumbnailRect.width, SELECTOR_LABEL_HEIGHT);
+		DrawTextEx(editor->font, name, namePosition, 16.0f, 1.0f, BLACK);
+		EndScissorMode();
+	}
+}
+
+// The atlas and its mipmaps come pre-rasterized from baked_font.h
+Font LoadBakedFont(void)
+{
+	int atlasSize = 0;
+	unsigned char *pixels = DecompressData(bakedFontAtlas, sizeof(bakedFontAtlas), &atlasSize);
+	assert(pixels != NULL && atlasSize == BAKED_FONT_ATLAS_SIZE);
+
+	Image atlas = {
+		.data = pixels,
+		.width = BAKED_FONT_ATLAS_WIDTH,
+		.height = BAKED_FONT_ATLAS_HEIGHT,
+		.mipmaps = BAKED_FONT_ATLAS_MIPMAPS,
+		.format = BAKED_FONT_ATLAS_FORMAT,
+	};
+
+	Font font = {
+		.baseSize = BAKED_FONT_BASE_SIZE,
+		.glyphCount = BAKED_FONT_GLYPH_COUNT,
+		.glyphPadding = BAKED_FONT_GLYPH_PADDING,
+		.texture = LoadTextureFromImage(atlas),
+		.recs = bakedFontRecs,
+		.glyphs = bakedFontGlyphs,
+	};
+	MemFree(pixels);
+
+	return font;
+}
+
+// Stands in for a level that is still loading, scaled up from its thumbnail.
+void DrawLevelPlaceholder(WorkspaceEntry *entry)
+{
+	if (entry->thumbnail.id == 0)
+		return;
+
+	float size = (GetRenderWidth() < GetRenderHeight()) ? GetRenderWidth() : GetRenderHeight();
+	Rectangle source = {0, 0, entry->thumbnail.width, entry->thumbnail.height};
+	Rectangle dest = {0.5f * (GetRenderWidth() - size), 0.5f * (GetRenderHeight() - size), size, size};
+	DrawTexturePro(entry->thumbnail, source, dest, CLITERAL(Vector2){0}, 0.0f, WHITE);
+}
+
+void Draw(Editor *editor)
+{
+	Workspace *workspace = &editor->workspace;
+
+	if (workspace->pendingActive >= 0)
+	{
+		ClearBackground(COLOR_BACKGROUND);
+		DrawLevelPlaceholder(&workspace->entries[workspace->pendingActive]);
+		DrawWorkspaceSelector(editor);
+		return;
+	}
+
+	Level level = editor->level;
+
+	Color backgroundColor = COLOR_BACKGROUND;
+
+	if (editor->mode == MODE_PLAY)
+	{
+		backgroundColor = COLOR_BACKGROUND_PLAY;
+		if (editor->isPuzzleSolved)
+		{
+			backgroundColor = COLOR_BACKGROUND_PUZZLE_SOLVED;
+		}
+	}
+
+	TileRect visible = GetVisibleTileRect(editor->camera, level);
+
+	bool isOverview = IsOverviewZoom(editor->camera.zoom);
+
+	PrepareLevelRenderCache(&editor->renderCache, level, editor->camera.zoom);
+	if (isOverview)
+	{
+		UpdateLevelOverview(&editor->renderCache.overview, level);
+		// Nothing is drawn from the chunks, let them age out
+		UpdateLevelRenderCache(&editor->renderCache, level, &editor->digits, CLITERAL(TileRect){0});
+	}
+	else
+	{
+		BakeDigitAtlas(&editor->digits, editor->font, editor->renderCache.texelsPerTile);
+		UpdateLevelRenderCache(&editor->renderCache, level, &editor->digits, visible);
+	}
+
+	ClearBackground(backgroundColor);
+	BeginMode2D(editor->camera);
+	{
+		if (isOverview)
+		{
+			DrawLevelOverview(&editor->renderCache.overview);
+		}
+		else
+		{
+			DrawLevelRenderCache(&editor->renderCache, visible);
+		}
+		if (editor->isSelecting)
+		{
+			DrawSelection(editor);
+		}
+		else
+		{
+			DrawTileCursor(editor);
+		}
+		DrawBranchLamps(&editor->branches, level, visible);
+		DrawViolations(&editor->violations, visible);
+	}
+	EndMode2D();
+
+	if (IsWorkspaceOpen(&editor->workspace))
+	{
+		DrawWorkspaceSelector(editor);
+	}
+
+	if (editor->showDebugText)
+	{
+		DrawDebugInfo(editor);
+	}
+}
+
+// Returns whether any tile changed.
+bool PutTileLine(Level level, int xStart, int yStart, int xEnd, int yEnd, Tile tile, LevelRenderCache *renderCache)
+{
+	bool changed = false;
+
+	int xDelta = xEnd - xStart;
+	int xStep = 1;
+	if (xEnd < xStart) { xStep = -1; xDelta = -xDelta; }
+	
+	int yDelta = yStart - yEnd;
+	int yStep = 1;
+	if (yEnd < yStart) { yStep = -1; yDelta = -yDelta; }
+	
+	int x = xStart;
+	int y = yStart;
+	int error = xDelta + yDelta;
+
+	for (;;)
+	{
+		changed |= PutTile(level, x, y, tile, renderCache);
+		if (x == xEnd && y == yEnd) break;
+
+		int e2 = 2 * error;
+
+		if (e2 >= yDelta)
+		{
+			if (x == xEnd) break;
+			error += yDelta;
+			x += xStep;
+		}
+
+		if (e2 <= xDelta)
+		{
+			if (y == yEnd) break;
+			error += xDelta;
+			y += yStep;
+		}
+	}
+
+	return changed;
+}
+
+void CameraSetZoomTarget(Camera2D *camera, Vector2 target)
+{
+	Vector2 worldTarget = GetScreenToWorld2D(target, *camera);
+	camera->offset = target;
+	camera->target = worldTarget;
+}
+
+void CameraZoomByFactor(Camera2D *camera, float zoomFactor, float zoomMin, float zoomMax)
+{
+	camera->zoom += zoomFactor * camera->zoom;
+	camera->zoom = Clamp(camera->zoom, zoomMin, zoomMax);
+}
+
+typedef struct LightingPass
+{
+	Level level;
+	bool *isLit;
+	// One per column, for the column sweeps
+	bool *seesLamp;
+	// Per row, the half-open span of tiles that changed
+	int *changedMinX;
+	int *changedMaxX;
+} LightingPass;
+
+// A floor tile is lit when a lamp sits in the same run of non-wall tiles of its
+// row or column. Rows are independent of each other, and so are columns.
+void LightRowsTask(void *data, int task, int beginY, int endY)
+{
+	(void)task;
+	LightingPass *pass = (LightingPass *)data;
+	Level level = pass->level;
+
+	for (int tileY = beginY; tileY < endY; ++tileY)
+	{
+		int rowIndex = GetTileIndex(level, 0, tileY);
+		Tile *row = &level.tiles[rowIndex];
+		bool *rowIsLit = &pass->isLit[rowIndex];
+
+		bool seesLamp = false;
+		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
+		{
+			TileKind kind = row[tileX].kind;
+			if (kind == TILE_WALL) seesLamp = false;
+			else if (kind == TILE_LAMP) seesLamp = true;
+			else if (seesLamp) rowIsLit[tileX] = true;
+		}
+
+		seesLamp = false;
+		for (int tileX = level.tileCountX - 1; tileX >= 0; --tileX)
+		{
+			TileKind kind = row[tileX].kind;
+			if (kind == TILE_WALL) seesLamp = false;
+			else if (kind == TILE_LAMP) seesLamp = true;
+			else if (seesLamp) rowIsLit[tileX] = true;
+		}
+	}
+}
+
+// Columns [beginX, endX), swept down and up row by row to stay cache friendly.
+void LightColumnsTask(void *data, int task, int beginX, int endX)
+{
+	(void)task;
+	LightingPass *pass = (LightingPass *)data;
+	Level level = pass->level;
+
+	bool *seesLamp = &pass->seesLamp[beginX];
+	memset(seesLamp, 0, sizeof(*seesLamp) * (endX - beginX));
+
+	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	{
+		int rowIndex = GetTileIndex(level, 0, tileY);
+		Tile *row = &level.tiles[rowIndex];
+		bool *rowIsLit = &pass->isLit[rowIndex];
+
+		for (int tileX = beginX; tileX < endX; ++tileX)
+		{
+			TileKind kind = row[tileX].kind;
+			if (kind == TILE_WALL) seesLamp[tileX - beginX] = false;
+			else if (kind == TILE_LAMP) seesLamp[tileX - beginX] = true;
+			else if (seesLamp[tileX - beginX]) rowIsLit[tileX] = true;
+		}
+	}
+
+	memset(seesLamp, 0, sizeof(*seesLamp) * (endX - beginX));
+
+	for (int tileY = level.tileCountY - 1; tileY >= 0; --tileY)
+	{
+		int rowIndex = GetTileIndex(level, 0, tileY);
+		Tile *row = &level.tiles[rowIndex];
+		bool *rowIsLit = &pass->isLit[rowIndex];
+
+		for (int tileX = beginX; tileX < endX; ++tileX)
+		{
+			TileKind kind = row[tileX].kind;
+			if (kind == TILE_WALL) seesLamp[tileX - beginX] = false;
+			else if (kind == TILE_LAMP) seesLamp[tileX - beginX] = true;
+			else if (seesLamp[tileX - beginX]) rowIsLit[tileX] = true;
+		}
+	}
+}
+
+void ApplyLitRowsTask(void *data, int task, int beginY, int endY)
+{
+	(void)task;
+	LightingPass *pass = (LightingPass *)data;
+	Level level = pass->level;
+
+	for (int tileY = beginY; tileY < endY; ++tileY)
+	{
+		pass->changedMinX[tileY] = level.tileCountX;
+		pass->changedMaxX[tileY] = 0;
+
+		int rowIndex = GetTileIndex(level, 0, tileY);
+		Tile *row = &level.tiles[rowIndex];
+		bool *rowIsLit = &pass->isLit[rowIndex];
+
+		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
+		{
+			Tile *tile = &row[tileX];
+			if (tile->kind != TILE_EMPTY && tile->kind != TILE_LIT)
+			{
+				continue;
+			}
+
+			TileKind kind = rowIsLit[tileX] ? TILE_LIT : TILE_EMPTY;
+			if (tile->kind != kind)
+			{
+				tile->kind = kind;
+				if (tileX < pass->changedMinX[tileY]) pass->changedMinX[tileY] = tileX;
+				pass->changedMaxX[tileY] = tileX + 1;
+			}
+		}
+	}
+}
+
+// jobs may be NULL, then everything runs on the calling thread. The scratch
+// buffers come from scratch if given, else from the heap. Edits that repeat
+// every frame pass the frame arena, one-off passes such as paste, resize or a
+// reload use the heap so the arena does not grow to fit them for good.
+void UpdateLitTiles(Level level, LevelRenderCache *renderCache, JobSystem *jobs, Arena *scratch)
+{
+	// Light into a scratch buffer first, so only tiles that actually change
+	// get written back and invalidated.
+	LightingPass pass = {.level = level};
+	int storageCount = GetLevelTileStorageCount(level);
+	if (scratch != NULL)
+	{
+		pass.isLit = (bool *)ArenaCalloc(scratch, storageCount + 1, sizeof(*pass.isLit));
+		pass.seesLamp = (bool *)ArenaAlloc(scratch, sizeof(*pass.seesLamp) * (level.tileCountX + 1));
+		pass.changedMinX = (int *)ArenaAlloc(scratch, sizeof(int) * (level.tileCountY + 1));
+		pass.changedMaxX = (int *)ArenaAlloc(scratch, sizeof(int) * (level.tileCountY + 1));
+	}
+	else
+	{
+		pass.isLit = (bool *)ZK_CALLOC(storageCount + 1, sizeof(*pass.isLit));
+		pass.seesLamp = (bool *)ZK_MALLOC(sizeof(*pass.seesLamp) * (level.tileCountX + 1));
+		pass.changedMinX = (int *)ZK_MALLOC(sizeof(int) * (level.tileCountY + 1));
+		pass.changedMaxX = (int *)ZK_MALLOC(sizeof(int) * (level.tileCountY + 1));
+		assert(pass.isLit != NULL && pass.seesLamp != NULL && pass.changedMinX != NULL && pass.changedMaxX != NULL);
+	}
+
+	int tileCount = level.tileCountX * level.tileCountY;
+	int rowTaskCount = GetParallelTaskCount(jobs, level.tileCountY, tileCount);
+	int columnTaskCount = GetParallelTaskCount(jobs, level.tileCountX, tileCount);
+
+	// The passes run one after the other, so no tile is written by two threads at once
+	ParallelFor(jobs, level.tileCountY, rowTaskCount, LightRowsTask, &pass);
+	ParallelFor(jobs, level.tileCountX, columnTaskCount, LightColumnsTask, &pass);
+	ParallelFor(jobs, level.tileCountY, rowTaskCount, ApplyLitRowsTask, &pass);
+
+	// The render cache is not thread safe, invalidate from here
+	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	{
+		if (pass.changedMinX[tileY] < pass.changedMaxX[tileY])
+		{
+			InvalidateTileRect(renderCache, CLITERAL(TileRect){pass.changedMinX[tileY], tileY, pass.changedMaxX[tileY], tileY + 1});
+		}
+	}
+
+	if (scratch == NULL)
+	{
+		free(pass.isLit);
+		free(pass.seesLamp);
+		free(pass.changedMinX);
+		free(pass.changedMaxX);
+	}
+}
+
+// The run of non-wall tiles through a tile along a row (dx = 1) or column (dy = 1).
+// The border walls end both walks.
+TileRect GetTileSegment(Level level, int tileX, int tileY, int dx, int dy)
+{
+	Tile *tile = GetTile(level, tileX, tileY);
+	int step = dx + dy * level.stride;
+	int before = 0;
+	int after = 0;
+
+	while (tile[-(before + 1) * step].kind != TILE_WALL) ++before;
+	while (tile[(after + 1) * step].kind != TILE_WALL) ++after;
+
+	return CLITERAL(TileRect){
+		tileX - before * dx,
+		tileY - before * dy,
+		tileX + after * dx + 1,
+		tileY + after * dy + 1,
+	};
+}
+
+// Whether a lamp other than the tile itself lies in the row (dx = 1) or column
+// (dy = 1) segment through it.
+bool IsLampInSegment(Level level, int tileX, int tileY, int dx, int dy)
+{
+	Tile *tile = GetTile(level, tileX, tileY);
+	int step = dx + dy * level.stride;
+
+	for (Tile *at = tile + step; at->kind != TILE_WALL; at += step)
+	{
+		if (at->kind == TILE_LAMP)
+			return true;
+	}
+
+	for (Tile *at = tile - step; at->kind != TILE_WALL; at -= step)
+	{
+		if (at->kind == TILE_LAMP)
+			return true;
+	}
+
+	return false;
+}
+
+int CountSegmentLamps(Level level, TileRect segment)
+{
+	int count = 0;
+
+	for (int tileY = segment.minY; tileY < segment.maxY; ++tileY)
+	{
+		Tile *row = GetTile(level, 0, tileY);
+
+		for (int tileX = segment.minX; tileX < segment.maxX; ++tileX)
+		{
+			count += row[tileX].kind == TILE_LAMP;
+		}
+	}
+
+	return count;
+}
+
+// How the number of unlit tiles changes when a tile goes from one kind to another.
+int GetUnlitTileDelta(TileKind previousKind, TileKind kind)
+{
+	return (kind == TILE_EMPTY) - (previousKind == TILE_EMPTY);
+}
+
+// segmentLampCount holds the lamps in the segment being walked, only the
+// crossing segment along dx, dy is searched here. Returns the change in the
+// number of unlit tiles.
+int RelightTile(Level level, int tileX, int tileY, int segmentLampCount, int dx, int dy, LevelRenderCache *renderCache)
+{
+	Tile *tile = GetTile(level, tileX, tileY);
+	if (tile->kind != TILE_EMPTY && tile->kind != TILE_LIT)
+		return 0;
+
+	bool isSeen = segmentLampCount > 0 || IsLampInSegment(level, tileX, tileY, dx, dy);
+	TileKind kind = isSeen ? TILE_LIT : TILE_EMPTY;
+	if (tile->kind == kind)
+		return 0;
+
+	int unlitDelta = GetUnlitTileDelta(tile->kind, kind);
+	tile->kind = kind;
+	InvalidateTile(renderCache, tileX, tileY);
+	return unlitDelta;
+}
+
+typedef struct TileSegment
+{
+	TileRect rect;
+	int dx;
+	int dy;
+} TileSegment;
+
+// The row and column segments through a tile. A wall splits them, then each
+// side next to it is a segment of its own. Returns the segment count.
+int GetTileSegmentsAround(Level level, int tileX, int tileY, TileSegment segments[4])
+{
+	if (GetTile(level, tileX, tileY)->kind != TILE_WALL)
+	{
+		segments[0] = CLITERAL(TileSegment){GetTileSegment(level, tileX, tileY, 1, 0), 1, 0};
+		segments[1] = CLITERAL(TileSegment){GetTileSegment(level, tileX, tileY, 0, 1), 0, 1};
+		return 2;
+	}
+
+	static const int around[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+	int count = 0;
+	for (int neighbor = 0; neighbor < 4; ++neighbor)
+	{
+		int x = tileX + around[neighbor][0];
+		int y = tileY + around[neighbor][1];
+		int dx = abs(around[neighbor][0]);
+		int dy = abs(around[neighbor][1]);
+
+		if (GetTile(level, x, y)->kind != TILE_WALL)
+		{
+			segments[count++] = CLITERAL(TileSegment){GetTileSegment(level, x, y, dx, dy), dx, dy};
+		}
+	}
+	return count;
+}
+
+// After a lamp was placed or removed, only the row and column segments
+// through it can change. Returns the change in the number of unlit tiles.
+int UpdateLitTilesAround(Level level, int tileX, int tileY, LevelRenderCache *renderCache)
+{
+	TileSegment segments[4];
+	int segmentCount = GetTileSegmentsAround(level, tileX, tileY, segments);
+	int unlitDelta = 0;
+
+	for (int i = 0; i < segmentCount; ++i)
+	{
+		TileSegment segment = segments[i];
+		int lampCount = CountSegmentLamps(level, segment.rect);
+
+		for (int y = segment.rect.minY; y < segment.rect.maxY; ++y)
+		{
+			for (int x = segment.rect.minX; x < segment.rect.maxX; ++x)
+			{
+				unlitDelta += RelightTile(level, x, y, lampCount, segment.dy, segment.dx, renderCache);
+			}
+		}
+	}
+
+	return unlitDelta;
+}
+
+// A lamp is seen when its segment holds another lamp (segmentLampCount counts
+// the lamp too) or its crossing segment along dx, dy holds one.
+void AddLampViolationIfSeen(Level level, int tileX, int tileY, int segmentLampCount, int dx, int dy, Violations *violations)
+{
+	if (GetTile(level, tileX, tileY)->kind != TILE_LAMP)
+		return;
+
+	if (segmentLampCount > 1 || IsLampInSegment(level, tileX, tileY, dx, dy))
+	{
+		AddViolation(violations, CLITERAL(Violation){
+			.kind = VIOLATION_LAMP_LIT_BY_OTHER_LAMP,
+			.tileX = tileX,
+			.tileY = tileY,
+		});
+	}
+}
+
+// Same for violations: lamps in the row and column segments, and the tile
+// and the walls next to it. Lamps that see each other are reported once per lamp.
+void UpdateViolationsAround(Level level, int tileX, int tileY, Violations *violations)
+{
+	TileRect row = GetTileSegment(level, tileX, tileY, 1, 0);
+	TileRect column = GetTileSegment(level, tileX, tileY, 0, 1);
+
+	int count = 0;
+	for (int i = 0; i < violations->count; ++i)
+	{
+		Violation violation = violations->items[i];
+		int distance = abs(violation.tileX - tileX) + abs(violation.tileY - tileY);
+		bool isAround = IsTileInRect(row, violation.tileX, violation.tileY)
+			|| IsTileInRect(column, violation.tileX, violation.tileY)
+			|| distance == 1;
+
+		if (!isAround)
+		{
+			violations->items[count++] = violation;
+		}
+	}
+	violations->count = count;
+
+	TileSegment segments[4];
+	int segmentCount = GetTileSegmentsAround(level, tileX, tileY, segments);
+
+	for (int i = 0; i < segmentCount; ++i)
+	{
+		TileSegment segment = segments[i];
+		int lampCount = CountSegmentLamps(level, segment.rect);
+
+		for (int y = segment.rect.minY; y < segment.rect.maxY; ++y)
+		{
+			for (int x = segment.rect.minX; x < segment.rect.maxX; ++x)
+			{
+				// The tile itself is in both segments when it is not a wall
+				if (segment.dy == 1 && y == tileY)
+					continue;
+
+				AddLampViolationIfSeen(level, x, y, lampCount, segment.dy, segment.dx, violations);
+			}
+		}
+	}
+
+	// Border walls have no requirement, so the neighbors need no bounds checks
+	static const int around[5][2] = {{0, 0}, {1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+	for (int neighbor = 0; neighbor < 5; ++neighbor)
+	{
+		int x = tileX + around[neighbor][0];
+		int y = tileY + around[neighbor][1];
+		Tile *tile = GetTile(level, x, y);
+
+		if (tile->kind == TILE_WALL && tile->lampRequirement >= 0
+			&& CountNeighborLamps(level, x, y) != tile->lampRequirement)
+		{
+			AddViolation(violations, CLITERAL(Violation){
+				.kind = VIOLATION_LAMP_REQUIREMENT,
+				.tileX = x,
+				.tileY = y,
+			});
+		}
+	}
+}
+
+size_t GetSafeLevelStringSize(Level level)
+{
+	const size_t size_for_width = 12;
+	const size_t size_for_height = 12;
+
+	return sizeof(char) * (
+		size_for_width + 1 +
+		size_for_height + 1 +
+		level.tileCountY * (level.tileCountX + 1) + 1);
+}
+
+size_t SaveLevelToString(Level level, char *outputBuffer, size_t outputBufferSize)
+{
+	char *at = outputBuffer;
+	char *end = outputBuffer + outputBufferSize;
+
+	at += snprintf(at, (end - at), "%d\n%d\n", level.tileCountX, level.tileCountY);
+
+	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	{
+		Tile *row = GetTile(level, 0, tileY);
+		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
+		{
+			char c = '?';
+			Tile tile = row[tileX];
+			switch (tile.kind)
+			{
+				case TILE_WALL:
+				{
+					if (tile.lampRequirement >= 0)
+					{
+						c = tile.lampRequirement | '0';
+					}
+					else
+					{
+						c = '#';
+					}
+				} break;
+
+				case TILE_LAMP: c = 'L'; break;
+
+				case TILE_EMPTY:
+				case TILE_LIT: c = '.'; break;
+				default:
+					break;
+			}
+
+			at += snprintf(at, (end - at), "%c", c);
+		}
+		at += snprintf(at, (end - at), "\n");
+	}
+	at += snprintf(at, (end - at), "%c", '\0');
+
+	return (size_t)(at - outputBuffer);
+}
+
+void EatWhitespace(char **at, char *end)
+{
+	while (*at < end && **at != '\0' && **at <= ' ') ++*at;
+}
+
+bool TryLoadLevelFromString(const char *buffer, size_t bufferSize, Level *outLevel)
+{
+	Level level = {0};
+
+	char *at = (char *)buffer;
+	char *end = at + bufferSize;
+
+	char *next_at;
+	level.tileCountX = strtol(at, &next_at, 10);
+	if (at == next_at) return false;
+	if (level.tileCountX > LEVEL_MAX_TILE_COUNT) return false;
+	at = next_at;
+	EatWhitespace(&at, end);
+	level.tileCountY = strtol(at, &next_at, 10);
+	if (at == next_at) return false;
+	if (level.tileCountY > LEVEL_MAX_TILE_COUNT) return false;
+	at = next_at;
+
+	if (level.tileCountX < 0 || level.tileCountY < 0) return false;
+
+	// Parse into new tiles, so the current level survives a failed load
+	level = CreateLevel(level.tileCountX, level.tileCountY);
+
+	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	{
+		Tile *row = GetTile(level, 0, tileY);
+		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
+		{
+			EatWhitespace(&at, end);
+			if (at >= end) goto ErrorReturn;
+
+			char c = *at;
+			Tile *tile = &row[tileX];
+			switch (c)
+			{
+				case '#':
+				case '0':
+				case '1':
+				case '2':
+				case '3':
+				case '4':
+				{
+					tile->kind = TILE_WALL;
+					tile->lampRequirement = (c == '#') ? -1 : c - '0';
+				} break;
+
+				case 'L': tile->kind = TILE_LAMP; break;
+
+				case '.': tile->kind = TILE_EMPTY; break;
+
+				default:
+					goto ErrorReturn;
+			}
+
+			++at;
+		}
+		EatWhitespace(&at, end);
+	}
+
+	free(outLevel->tiles);
+	*outLevel = level;
+	return true;
+
+ErrorReturn:
+	free(level.tiles);
+	return false;
+}
+
+// Write next to the target and rename over it, so a crash mid-write never
+// leaves a truncated file behind.
+bool SaveFileDataReplacing(const char *path, void *data, int dataSize)
+{
+	char tempPath[1024];
+	snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+	bool saved = SaveFileData(tempPath, data, dataSize);
+
+	if (saved)
+	{
+#ifdef _WIN32
+		remove(path);
+#endif
+		saved = rename(tempPath, path) == 0;
+	}
+
+	return saved;
+}
+
+bool SaveLevelFile(Level level, const char *path)
+{
+	size_t textSize = GetSafeLevelStringSize(level);
+	char *text = (char *)ZK_MALLOC(textSize);
+	assert(text != NULL);
+	size_t textLength = SaveLevelToString(level, text, textSize);
+
+	// Without the terminator, like a hand written file
+	bool saved = SaveFileDataReplacing(path, text, (int)textLength - 1);
+	free(text);
+
+	return saved;
+}
+
+bool TryLoadLevelFile(const char *path, Level *outLevel)
+{
+	char *text = LoadFileText(path);
+	if (text == NULL)
+		return false;
+
+	bool loaded = TryLoadLevelFromString(text, strlen(text), outLevel);
+	UnloadFileText(text);
+
+	return loaded;
+}
+
+bool SaveLevelCompressed(Level level, const char *path)
+{
+	size_t textSize = GetSafeLevelStringSize(level);
+	char *text = (char *)ZK_MALLOC(textSize);
+	assert(text != NULL);
+	size_t textLength = SaveLevelToString(level, text, textSize);
+
+	int compressedSize = 0;
+	unsigned char *compressed = CompressData((unsigned char *)text, (int)textLength, &compressedSize);
+	free(text);
+
+	if (compressed == NULL)
+		return false;
+
+	bool saved = SaveFileDataReplacing(path, compressed, compressedSize);
+	MemFree(compressed);
+
+	return saved;
+}
+
+bool TryLoadLevelCompressed(const char *path, Level *outLevel)
+{
+	if (!FileExists(path))
+		return false;
+
+	int compressedSize = 0;
+	unsigned char *compressed = LoadFileData(path, &compressedSize);
+	if (compressed == NULL)
+		return false;
+
+	int textSize = 0;
+	unsigned char *text = DecompressData(compressed, compressedSize, &textSize);
+	UnloadFileData(compressed);
+
+	if (text == NULL)
+		return false;
+
+	bool loaded = TryLoadLevelFromString((const char *)text, textSize, outLevel);
+	MemFree(text);
+
+	return loaded;
+}
+
+uint32_t HashFnv1a(const unsigned char *data, size_t size)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+void CloseLevelPack(LevelPack *pack)
+{
+#ifndef _WIN32
+	if (pack->isMapped)
+	{
+		munmap(pack->data, pack->size);
+	}
+	else
+#endif
+	{
+		UnloadFileData(pack->data);
+	}
+	free(pack->path);
+	*pack = CLITERAL(LevelPack){0};
+}
+
+// Checks the header and that every entry lies within the file. The payloads
+// themselves are only read when a level is opened.
+bool TryOpenLevelPack(const char *path, LevelPack *outPack)
+{
+	LevelPack pack = {0};
+
+#ifndef _WIN32
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) == 0 && fileStat.st_size >= (off_t)sizeof(PackHeader))
+	{
+		void *data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data != MAP_FAILED)
+		{
+			pack.data = (unsigned char *)data;
+			pack.size = (size_t)fileStat.st_size;
+			pack.isMapped = true;
+		}
+	}
+	close(file);
+#else
+	int dataSize = 0;
+	pack.data = LoadFileData(path, &dataSize);
+	pack.size = (size_t)dataSize;
+#endif
+
+	if (pack.data == NULL)
+		return false;
+
+	const PackHeader *header = (const PackHeader *)pack.data;
+	if (pack.size < sizeof(*header)
+		|| memcmp(header->magic, PACK_MAGIC, sizeof(header->magic)) != 0
+		|| header->version != PACK_VERSION
+		|| header->levelCount > (pack.size - sizeof(*header)) / sizeof(PackEntry))
+	{
+		goto ErrorReturn;
+	}
+
+	pack.levelCount = (int)header->levelCount;
+	pack.entries = (const PackEntry *)(pack.data + sizeof(*header));
+
+	for (int index = 0; index < pack.levelCount; ++index)
+	{
+		PackEntry entry = pack.entries[index];
+		if (entry.size == 0 || entry.offset > pack.size || entry.size > pack.size - entry.offset
+			|| entry.tileCountX > LEVEL_MAX_TILE_COUNT || entry.tileCountY > LEVEL_MAX_TILE_COUNT)
+		{
+			goto ErrorReturn;
+		}
+	}
+
+	size_t pathSize = strlen(path) + 1;
+	pack.path = (char *)ZK_MALLOC(pathSize);
+	assert(pack.path != NULL);
+	memcpy(pack.path, path, pathSize);
+
+	*outPack = pack;
+	return true;
+
+ErrorReturn:
+	CloseLevelPack(&pack);
+	return false;
+}
+
+bool IsPackedLevelIntact(LevelPack *pack, int index)
+{
+	PackEntry entry = pack->entries[index];
+	return HashFnv1a(pack->data + entry.offset, entry.size) == entry.hash;
+}
+
+bool TryLoadPackedLevel(LevelPack *pack, int index, Level *outLevel)
+{
+	if (index < 0 || index >= pack->levelCount)
+		return false;
+
+	PackEntry entry = pack->entries[index];
+	const char *payload = (const char *)pack->data + entry.offset;
+
+	// The terminator keeps the parser inside the payload
+	if (payload[entry.size - 1] != '\0')
+		return false;
+
+	return TryLoadLevelFromString(payload, entry.size, outLevel);
+}
+
+bool TryLoadLevelSource(LevelSource source, Level *outLevel)
+{
+	if (source.pack != NULL)
+	{
+		return TryLoadPackedLevel(source.pack, source.packIndex, outLevel);
+	}
+	return TryLoadLevelFile(source.path, outLevel);
+}
+
+// Writes the levels as a pack, in order. Levels are stored in the same text
+// form SaveLevelToString produces.
+bool SaveLevelPack(const char *path, Level *levels, int levelCount)
+{
+	FILE *file = fopen(path, "wb");
+	if (file == NULL)
+		return false;
+
+	PackHeader header = {
+		.version = PACK_VERSION,
+		.levelCount = (uint32_t)levelCount,
+	};
+	memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+
+	PackEntry *entries = (PackEntry *)ZK_CALLOC(levelCount + 1, sizeof(*entries));
+	assert(entries != NULL);
+
+	// Payloads go after the index, which is written last once the offsets are known
+	uint64_t offset = sizeof(header) + sizeof(*entries) * levelCount;
+	bool saved = fseek(file, (long)offset, SEEK_SET) == 0;
+
+	for (int index = 0; saved && index < levelCount; ++index)
+	{
+		Level level = levels[index];
+		size_t textSize = GetSafeLevelStringSize(level);
+		char *text = (char *)ZK_MALLOC(textSize);
+		assert(text != NULL);
+		size_t textLength = SaveLevelToString(level, text, textSize);
+
+		entries[index] = CLITERAL(PackEntry){
+			.offset = offset,
+			.size = (uint32_t)textLength,
+			.tileCountX = (uint32_t)level.tileCountX,
+			.tileCountY = (uint32_t)level.tileCountY,
+			.hash = HashFnv1a((const unsigned char *)text, textLength),
+		};
+		saved = fwrite(text, 1, textLength, file) == textLength;
+		offset += textLength;
+		free(text);
+	}
+
+	saved = saved
+		&& fseek(file, 0, SEEK_SET) == 0
+		&& fwrite(&header, sizeof(header), 1, file) == 1
+		&& (levelCount == 0 || fwrite(entries, sizeof(*entries), levelCount, file) == (size_t)levelCount);
+
+	saved &= fclose(file) == 0;
+	free(entries);
+
+	return saved;
+}
+
+LevelSnapshot *CreateLevelSnapshot(Level level)
+{
+	LevelSnapshot *snapshot = (LevelSnapshot *)ZK_MALLOC(sizeof(*snapshot));
+	assert(snapshot != NULL);
+
+	// Rows past the last one are slack, leave them out
+	size_t tilesSize = sizeof(*level.tiles) * GetLevelTileStorageCount(level);
+	snapshot->level = level;
+	snapshot->level.capacityY = level.tileCountY + 2;
+	snapshot->level.tiles = (Tile *)ZK_MALLOC(tilesSize);
+	assert(snapshot->level.tiles != NULL);
+	memcpy(snapshot->level.tiles, level.tiles, tilesSize);
+	snapshot->refCount = 1;
+
+	return snapshot;
+}
+
+LevelSnapshot *RetainLevelSnapshot(LevelSnapshot *snapshot)
+{
+	__atomic_add_fetch(&snapshot->refCount, 1, __ATOMIC_RELAXED);
+	return snapshot;
+}
+
+void ReleaseLevelSnapshot(LevelSnapshot *snapshot)
+{
+	if (snapshot == NULL)
+		return;
+
+	if (__atomic_sub_fetch(&snapshot->refCount, 1, __ATOMIC_ACQ_REL) == 0)
+	{
+		free(snapshot->level.tiles);
+		free(snapshot);
+	}
+}
+
+// A reference to a snapshot of the level as of the end of the last Update.
+// Snapshots are shared until the level changes. Release when done.
+LevelSnapshot *AcquireLevelSnapshot(Editor *editor)
+{
+	if (editor->levelSnapshot == NULL || editor->isLevelSnapshotStale)
+	{
+		ReleaseLevelSnapshot(editor->levelSnapshot);
+		editor->levelSnapshot = CreateLevelSnapshot(editor->level);
+		editor->isLevelSnapshotStale = false;
+	}
+
+	return RetainLevelSnapshot(editor->levelSnapshot);
+}
+
+typedef struct AutosaveJob
+{
+	Autosave *autosave;
+	LevelSnapshot *snapshot;
+	bool saved;
+} AutosaveJob;
+
+void RunAutosaveJob(void *data)
+{
+	AutosaveJob *job = (AutosaveJob *)data;
+	job->saved = SaveLevelCompressed(job->snapshot->level, AUTOSAVE_PATH);
+}
+
+void CompleteAutosaveJob(void *data)
+{
+	AutosaveJob *job = (AutosaveJob *)data;
+
+	if (!job->saved)
+	{
+		TraceLog(LOG_WARNING, "AUTOSAVE: Failed to write %s", AUTOSAVE_PATH);
+	}
+
+	job->autosave->isSaving = false;
+	ReleaseLevelSnapshot(job->snapshot);
+	free(job);
+}
+
+// Called at the end of a frame. Serializing, compressing and writing all
+// happen on a worker, from a snapshot.
+void UpdateAutosave(Editor *editor)
+{
+	Autosave *autosave = &editor->autosave;
+
+	// Workspace levels are saved to their own files with Ctrl+S
+	if (editor->workspace.active >= 0)
+		return;
+
+	if (!autosave->isLevelModified || autosave->isSaving)
+		return;
+
+	if (GetTime() - autosave->lastSaveTime < AUTOSAVE_INTERVAL_SECONDS)
+		return;
+
+	AutosaveJob *job = (AutosaveJob *)ZK_MALLOC(sizeof(*job));
+	assert(job != NULL);
+	*job = CLITERAL(AutosaveJob){
+		.autosave = autosave,
+		.snapshot = AcquireLevelSnapshot(editor),
+	};
+
+	autosave->isSaving = true;
+	autosave->isLevelModified = false;
+	autosave->lastSaveTime = GetTime();
+
+	SubmitJob(&editor->jobs, CLITERAL(Job){RunAutosaveJob, CompleteAutosaveJob, job});
+}
+
+void *WakeTimerThread(void *data)
+{
+	WakeTimer *timer = (WakeTimer *)data;
+
+	pthread_mutex_lock(&timer->mutex);
+	for (;;)
+	{
+		if (!timer->isArmed)
+		{
+			pthread_cond_wait(&timer->changed, &timer->mutex);
+		}
+		else if (pthread_cond_timedwait(&timer->changed, &timer->mutex, &timer->deadline) == ETIMEDOUT)
+		{
+			timer->isArmed = false;
+			glfwPostEmptyEvent();
+		}
+	}
+
+	return NULL;
+}
+
+// The timer thread runs until the process exits.
+void StartWakeTimer(WakeTimer *timer)
+{
+	*timer = CLITERAL(WakeTimer){0};
+	pthread_mutex_init(&timer->mutex, NULL);
+	pthread_cond_init(&timer->changed, NULL);
+
+	int result = pthread_create(&timer->thread, NULL, WakeTimerThread, timer);
+	assert(result == 0);
+	pthread_detach(timer->thread);
+}
+
+// Replaces any earlier deadline.
+void ArmWakeTimer(WakeTimer *timer, double seconds)
+{
+	struct timespec deadline;
+	timespec_get(&deadline, TIME_UTC);
+	if (seconds > 0.0)
+	{
+		long long nanoseconds = deadline.tv_nsec + (long long)(seconds * 1e9);
+		deadline.tv_sec += nanoseconds / 1000000000;
+		deadline.tv_nsec = nanoseconds % 1000000000;
+	}
+
+	pthread_mutex_lock(&timer->mutex);
+	timer->deadline = deadline;
+	timer->isArmed = true;
+	pthread_cond_signal(&timer->changed);
+	pthread_mutex_unlock(&timer->mutex);
+}
+
+// Seconds until UpdateAutosave starts a save, or -1 if none is waiting.
+double GetAutosaveDelay(Editor *editor)
+{
+	Autosave *autosave = &editor->autosave;
+
+	if (editor->workspace.active >= 0 || !autosave->isLevelModified || autosave->isSaving)
+		return -1.0;
 
-					foundViolation = true;
-					AddViolation(violations, CLITERAL(Violation){
-						.kind = VIOLATION_LAMP_LIT_BY_OTHER_LAMP,
-						.tileX = tileX,
-						.tileY = tileY,
-					});
-					AddViolation(violations, CLITERAL(Violation){
-						.kind = VIOLATION_LAMP_LIT_BY_OTHER_LAMP,
-						.tileX = checkX,
-						.tileY = tileY,
-					});
-					break;
-				}
+	double delay = AUTOSAVE_INTERVAL_SECONDS - (GetTime() - autosave->lastSaveTime);
+	return delay > 0.0 ? delay : 0.0;
+}
 
-				if (checkTile->kind == TILE_WALL)
-				{
-					break;
-				}
-			}
+// Write any unsaved changes before quitting.
+void FlushAutosave(Editor *editor)
+{
+	WaitForAllJobs(&editor->jobs);
 
-			// Check column
-			for (int checkY = tileY + 1; checkY < level.tileCountY; ++checkY)
-			{
-				checkTile = GetTile(level, tileX, checkY);
-				if (checkTile->kind == TILE_LAMP)
-				{
-					if (violations == NULL)
-					{
-						return true;
-					}
+	if (editor->autosave.isLevelModified && !SaveLevelCompressed(editor->level, AUTOSAVE_PATH))
+	{
+		TraceLog(LOG_WARNING, "AUTOSAVE: Failed to write %s", AUTOSAVE_PATH);
+	}
+}
 
-					foundViolation = true;
-					AddViolation(violations, CLITERAL(Violation){
-						.kind = VIOLATION_LAMP_LIT_BY_OTHER_LAMP,
-						.tileX = tileX,
-						.tileY = tileY,
-					});
-					AddViolation(violations, CLITERAL(Violation){
-						.kind = VIOLATION_LAMP_LIT_BY_OTHER_LAMP,
-						.tileX = tileX,
-						.tileY = checkY,
-					});
-					break;
-				}
+float GetLevelWidth(Level level)
+{
+	return level.tileCountX * TILE_SIZE;
+}
 
-				if (checkTile->kind == TILE_WALL)
-				{
-					break;
-				}
+float GetLevelHeight(Level level)
+{
+	return level.tileCountY * TILE_SIZE;
+}
+
+Vector2 GetViewportCenter()
+{
+	return CLITERAL(Vector2)
+	{
+		GetRenderWidth() * 0.5f,
+		GetRenderHeight() * 0.5f,
+	};
+}
+
+float GetZoomToFit(Level level)
+{
+	float widthRatio = GetRenderWidth() / GetLevelWidth(level);
+	float heightRatio = GetRenderHeight() / GetLevelHeight(level);
+
+	return widthRatio < heightRatio ? widthRatio : heightRatio;
+}
+
+void CenterView(Camera2D *camera, Level level)
+{
+	float levelWidth = GetLevelWidth(level);
+	float levelHeight = GetLevelHeight(level);
+
+	camera->zoom = GetZoomToFit(level);
+	camera->zoom *= 0.90;
+
+	camera->target = CLITERAL(Vector2)
+	{
+		0.5f*levelWidth,
+		0.5f*levelHeight,
+	};
+
+	camera->offset = GetViewportCenter();
+
+}
+
+void UpdateViolations(Editor *editor)
+{
+	ResetArena(&editor->levelArena);
+	editor->violations = CLITERAL(Violations){.arena = &editor->levelArena};
+	bool hasViolations = GetViolations(editor->level, &editor->violations, &editor->jobs);
+	editor->unlitTileCount = CountUnlitTiles(editor->level);
+	editor->isPuzzleSolved = !hasViolations && editor->unlitTileCount == 0;
+}
+
+// Places or removes a lamp in play mode. Lighting and violations are updated
+// around the tile only.
+void SetPlayTile(Editor *editor, int tileX, int tileY, TileKind kind)
+{
+	Branches *branches = &editor->branches;
+	Tile *tile = GetTile(editor->level, tileX, tileY);
+
+	if (tile->kind == TILE_WALL || (kind != TILE_LAMP && tile->kind != TILE_LAMP))
+		return;
+
+	if (branches->markCount > 0)
+	{
+		if (branches->count + 1 > branches->capacity)
+		{
+			branches->capacity = branches->capacity ? branches->capacity * 2 : 64;
+			branches->deltas = ZK_REALLOC(branches->deltas, sizeof(branches->deltas[0]) * branches->capacity);
+			assert(branches->deltas != NULL);
+		}
+		branches->deltas[branches->count++] = CLITERAL(BranchDelta){tileX, tileY, tile->kind};
+	}
+
+	editor->unlitTileCount += GetUnlitTileDelta(tile->kind, kind);
+	tile->kind = kind;
+	InvalidateTile(&editor->renderCache, tileX, tileY);
+	editor->unlitTileCount += UpdateLitTilesAround(editor->level, tileX, tileY, &editor->renderCache);
+	UpdateViolationsAround(editor->level, tileX, tileY, &editor->violations);
+	editor->isLevelTouched = true;
+}
+
+void StartBranch(Editor *editor)
+{
+	Branches *branches = &editor->branches;
+
+	if (branches->markCount + 1 > branches->markCapacity)
+	{
+		branches->markCapacity = branches->markCapacity ? branches->markCapacity * 2 : 8;
+		branches->marks = ZK_REALLOC(branches->marks, sizeof(branches->marks[0]) * branches->markCapacity);
+		assert(branches->marks != NULL);
+	}
+	branches->marks[branches->markCount++] = branches->count;
+}
+
+// The innermost branch becomes part of the one around it, or of the level.
+void CommitBranch(Editor *editor)
+{
+	Branches *branches = &editor->branches;
+
+	if (branches->markCount == 0)
+		return;
+
+	--branches->markCount;
+	if (branches->markCount == 0)
+	{
+		branches->count = 0;
+	}
+}
+
+// Undo the innermost branch, newest change first.
+void DiscardBranch(Editor *editor)
+{
+	Branches *branches = &editor->branches;
+
+	if (branches->markCount == 0)
+		return;
+
+	int mark = branches->marks[--branches->markCount];
+	while (branches->count > mark)
+	{
+		BranchDelta delta = branches->deltas[--branches->count];
+		Tile *tile = GetTile(editor->level, delta.tileX, delta.tileY);
+		editor->unlitTileCount += GetUnlitTileDelta(tile->kind, delta.previousKind);
+		tile->kind = delta.previousKind;
+		InvalidateTile(&editor->renderCache, delta.tileX, delta.tileY);
+		editor->unlitTileCount += UpdateLitTilesAround(editor->level, delta.tileX, delta.tileY, &editor->renderCache);
+		UpdateViolationsAround(editor->level, delta.tileX, delta.tileY, &editor->violations);
+	}
+	editor->isLevelTouched = true;
+}
+
+// Keeps every change, for when the level is replaced or play mode ends.
+void ClearBranches(Editor *editor)
+{
+	editor->branches.count = 0;
+	editor->branches.markCount = 0;
+}
+
+#ifdef __linux__
+// Blocks on the inotify events, so the main thread can sleep until there is
+// input or the watched file changed.
+void *FileWatchThread(void *data)
+{
+	FileWatch *watch = (FileWatch *)data;
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+	for (;;)
+	{
+		ssize_t size = read(watch->fd, buffer, sizeof(buffer));
+		if (size < 0 && errno == EINTR)
+			continue;
+		if (size <= 0)
+			break;
+
+		bool hasChanged = false;
+		pthread_mutex_lock(&watch->mutex);
+		for (char *at = buffer; at < buffer + size; )
+		{
+			struct inotify_event *event = (struct inotify_event *)at;
+			if (watch->path != NULL && event->wd == watch->watch && event->len > 0
+				&& strcmp(event->name, GetFileName(watch->path)) == 0)
+			{
+				hasChanged = true;
 			}
+			at += sizeof(*event) + event->len;
+		}
+		watch->hasChanged |= hasChanged;
+		pthread_mutex_unlock(&watch->mutex);
+
+		if (hasChanged)
+		{
+			glfwPostEmptyEvent();
 		}
 	}
-	return foundViolation;
+
+	return NULL;
 }
+#endif
 
-bool GetViolations(Level level, Violations *violations)
+// The watch thread runs until the process exits.
+void StartFileWatch(FileWatch *watch)
 {
-	bool foundViolation = false;
+	*watch = CLITERAL(FileWatch){.fd = -1, .watch = -1};
+	pthread_mutex_init(&watch->mutex, NULL);
 
-	// For all wall tiles,
-	//   if lamp requirement, check neighbor tiles for correct amount of lamps
-	foundViolation |= GetLampRequirementViolations(level, violations);
-	
-	// For all lamp tiles,
-	//   Check that they are not lit by another lamp
-	foundViolation |= GetLampLitByOtherLampViolations(level, violations);
+#ifdef __linux__
+	watch->fd = inotify_init1(IN_CLOEXEC);
+	if (watch->fd >= 0 && pthread_create(&watch->thread, NULL, FileWatchThread, watch) == 0)
+	{
+		pthread_detach(watch->thread);
+		return;
+	}
 
-	// If any ground tiles are not lit,
-	//   We have not completed the puzzle
-	return foundViolation;
+	if (watch->fd >= 0)
+	{
+		close(watch->fd);
+		watch->fd = -1;
+	}
+	TraceLog(LOG_WARNING, "WATCH: inotify is not available, changed files are not reloaded");
+#endif
+}
+
+// Watches path for being rewritten or replaced, NULL stops watching.
+void WatchFile(FileWatch *watch, const char *path)
+{
+	if (watch->fd < 0)
+		return;
+
+#ifdef __linux__
+	pthread_mutex_lock(&watch->mutex);
+	int previous = watch->watch;
+	watch->watch = -1;
+	watch->path = NULL;
+	watch->hasChanged = false;
+
+	if (path != NULL)
+	{
+		watch->watch = inotify_add_watch(watch->fd, GetDirectoryPath(path), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (watch->watch >= 0)
+		{
+			watch->path = path;
+		}
+		else
+		{
+			TraceLog(LOG_WARNING, "WATCH: Failed to watch %s", path);
+		}
+	}
+
+	// Files in the same directory share the watch
+	if (previous >= 0 && previous != watch->watch)
+	{
+		inotify_rm_watch(watch->fd, previous);
+	}
+	pthread_mutex_unlock(&watch->mutex);
+#else
+	(void)path;
+#endif
+}
+
+// True if the watched file changed since the last call.
+bool HasWatchedFileChanged(FileWatch *watch)
+{
+	if (watch->fd < 0)
+		return false;
+
+	pthread_mutex_lock(&watch->mutex);
+	bool hasChanged = watch->hasChanged;
+	watch->hasChanged = false;
+	pthread_mutex_unlock(&watch->mutex);
+
+	return hasChanged;
+}
+
+// Reads just the width and height at the start of a level file.
+bool TryReadLevelDimensions(const char *path, int *tileCountX, int *tileCountY)
+{
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+		return false;
+
+	char header[64];
+	size_t headerSize = fread(header, 1, sizeof(header) - 1, file);
+	fclose(file);
+	header[headerSize] = '\0';
+
+	char *at = header;
+	char *next_at;
+	long countX = strtol(at, &next_at, 10);
+	if (at == next_at) return false;
+	at = next_at;
+	long countY = strtol(at, &next_at, 10);
+	if (at == next_at) return false;
+
+	if (countX < 0 || countX > LEVEL_MAX_TILE_COUNT) return false;
+	if (countY < 0 || countY > LEVEL_MAX_TILE_COUNT) return false;
+
+	*tileCountX = (int)countX;
+	*tileCountY = (int)countY;
+	return true;
+}
+
+void AddWorkspaceEntry(Workspace *workspace, WorkspaceEntry entry)
+{
+	if (workspace->count + 1 > workspace->capacity)
+	{
+		workspace->capacity = workspace->capacity ? workspace->capacity * 2 : 64;
+		workspace->entries = ZK_REALLOC(workspace->entries, sizeof(workspace->entries[0]) * workspace->capacity);
+		assert(workspace->entries != NULL);
+	}
+
+	workspace->entries[workspace->count++] = entry;
+}
+
+void AddWorkspaceFile(Workspace *workspace, const char *path, int firstNewEntry)
+{
+	for (int index = 0; index < firstNewEntry; ++index)
+	{
+		if (strcmp(workspace->entries[index].source.path, path) == 0)
+			return;
+	}
+
+	int tileCountX, tileCountY;
+	if (!TryReadLevelDimensions(path, &tileCountX, &tileCountY))
+	{
+		TraceLog(LOG_WARNING, "WORKSPACE: Skipped %s, not a level", path);
+		return;
+	}
+
+	size_t pathSize = strlen(path) + 1;
+	char *pathCopy = (char *)ZK_MALLOC(pathSize);
+	assert(pathCopy != NULL);
+	memcpy(pathCopy, path, pathSize);
+
+	AddWorkspaceEntry(workspace, CLITERAL(WorkspaceEntry){
+		.source = {pathCopy, NULL, 0},
+		.tileCountX = tileCountX,
+		.tileCountY = tileCountY,
+	});
+}
+
+// Every level in the pack becomes an entry. The pack stays open for good.
+void AddWorkspacePack(Workspace *workspace, const char *path, int firstNewEntry)
+{
+	for (int index = 0; index < firstNewEntry; ++index)
+	{
+		if (strcmp(workspace->entries[index].source.path, path) == 0)
+			return;
+	}
+
+	LevelPack *pack = (LevelPack *)ZK_MALLOC(sizeof(*pack));
+	assert(pack != NULL);
+
+	if (!TryOpenLevelPack(path, pack))
+	{
+		TraceLog(LOG_WARNING, "WORKSPACE: Skipped %s, not a level pack", path);
+		free(pack);
+		return;
+	}
+
+	for (int index = 0; index < pack->levelCount; ++index)
+	{
+		AddWorkspaceEntry(workspace, CLITERAL(WorkspaceEntry){
+			.source = {pack->path, pack, index},
+			.tileCountX = (int)pack->entries[index].tileCountX,
+			.tileCountY = (int)pack->entries[index].tileCountY,
+		});
+	}
+}
+
+int ComparePaths(const void *a, const void *b)
+{
+	return strcmp(*(const char **)a, *(const char **)b);
+}
+
+void AddWorkspaceFileOrPack(Workspace *workspace, const char *path, int firstNewEntry)
+{
+	if (IsFileExtension(path, ".zkpack"))
+	{
+		AddWorkspacePack(workspace, path, firstNewEntry);
+	}
+	else if (IsFileExtension(path, ".zenkari"))
+	{
+		AddWorkspaceFile(workspace, path, firstNewEntry);
+	}
 }
 
-bool HasViolations(Level level)
+// Adds a level file, a level pack, or every one of them in a directory.
+// Returns how many levels were added.
+int AddWorkspacePath(Workspace *workspace, const char *path)
+{
+	int firstNewEntry = workspace->count;
+
+	if (DirectoryExists(path))
+	{
+		FilePathList files = LoadDirectoryFilesEx(path, ".zenkari;.zkpack", false);
+		qsort(files.paths, files.count, sizeof(files.paths[0]), ComparePaths);
+
+		for (unsigned int i = 0; i < files.count; ++i)
+		{
+			AddWorkspaceFileOrPack(workspace, files.paths[i], firstNewEntry);
+		}
+		UnloadDirectoryFiles(files);
+	}
+	else
+	{
+		AddWorkspaceFileOrPack(workspace, path, firstNewEntry);
+	}
+
+	return workspace->count - firstNewEntry;
+}
+
+// Unload inactive levels without unsaved changes until the rest fit the budget.
+void EvictWorkspaceLevels(Workspace *workspace)
+{
+	for (;;)
+	{
+		long loadedTileCount = 0;
+		int oldest = -1;
+
+		for (int index = 0; index < workspace->count; ++index)
+		{
+			WorkspaceEntry *entry = &workspace->entries[index];
+			if (entry->level.tiles == NULL)
+				continue;
+
+			loadedTileCount += (long)entry->level.tileCountX * entry->level.tileCountY;
+
+			if (!entry->isModified && (oldest < 0 || entry->lastUsed < workspace->entries[oldest].lastUsed))
+			{
+				oldest = index;
+			}
+		}
+
+		if (loadedTileCount <= WORKSPACE_MAX_LOADED_TILES || oldest < 0)
+			return;
+
+		free(workspace->entries[oldest].level.tiles);
+		workspace->entries[oldest].level = CLITERAL(Level){0};
+	}
+}
+
+typedef struct LevelLoadJob
+{
+	Editor *editor;
+	int entryIndex;
+	LevelSource source;
+	Level level;
+	bool loaded;
+} LevelLoadJob;
+
+void RunLevelLoadJob(void *data)
 {
-	return GetViolations(level, NULL);
-}
+	LevelLoadJob *job = (LevelLoadJob *)data;
+	job->loaded = TryLoadLevelSource(job->source, &job->level);
 
-Vector2 WorldCoordinateFromTile(int tileX, int tileY)
-{
-	return (Vector2){
-		tileX * TILE_SIZE,
-		tileY * TILE_SIZE,
-	};
+	if (job->loaded)
+	{
+		UpdateLitTiles(job->level, NULL, NULL, NULL);
+	}
 }
 
-void DrawViolations(Violations *violations)
+void CompleteLevelLoadJob(void *data)
 {
-	for (int i = 0; i < violations->count; ++i)
-	{
-		Violation violation = violations->items[i];
-		assert(violation.kind == VIOLATION_LAMP_REQUIREMENT || violation.kind == VIOLATION_LAMP_LIT_BY_OTHER_LAMP);
+	LevelLoadJob *job = (LevelLoadJob *)data;
+	Workspace *workspace = &job->editor->workspace;
+	WorkspaceEntry *entry = &workspace->entries[job->entryIndex];
 
-		Vector2 tileCoord = WorldCoordinateFromTile(violation.tileX, violation.tileY);
+	entry->isLoading = false;
 
-		DrawTileOutline(tileCoord.x, tileCoord.y, 4, RED);
+	if (!job->loaded && job->entryIndex == workspace->pendingActive)
+	{
+		TraceLog(LOG_WARNING, "WORKSPACE: Failed to load %s", entry->source.path);
+		workspace->pendingActive = -1;
+		job->editor->needsRedraw = true;
 	}
-}
 
-bool IsPuzzleSolved(Level level)
-{
-	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	// The level may have been opened in the meantime
+	if (job->loaded && entry->level.tiles == NULL && job->entryIndex != workspace->active)
 	{
-		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
-		{
-			if (GetTile(level, tileX, tileY)->kind == TILE_EMPTY)
-			{
-				return false;
-			}
-		}
+		entry->level = job->level;
+		entry->lastUsed = ++workspace->useCounter;
+		EvictWorkspaceLevels(workspace);
+	}
+	else
+	{
+		free(job->level.tiles);
 	}
 
-	return !HasViolations(level);
+	free(job);
 }
 
-void DrawDebugInfo(Editor *editor)
+// Parse a level on a worker, so switching to it later is immediate.
+void PrefetchWorkspaceLevel(Editor *editor, int index)
 {
-	Rectangle debugTextBounds = {
-		0.0f,
-		0.0f,
-		400.0f,
-		GetRenderHeight(),
-	};
-	DrawRectangleRec(debugTextBounds, (Color){255,255,255,160});
-	float fontSize = 24.0f;
-	float fontSpacing = 1.0f;
-	float pad = 20.0f;
-	Vector2 textPos = {pad, pad};
-	const char *text = TextFormat("Zoom: %d%%", (int)(editor->camera.zoom*100.0f));
-	Vector2 textDimensions = MeasureTextEx(editor->font, text, fontSize, fontSpacing);
-	DrawTextEx(editor->font, text, textPos, fontSize, fontSpacing, BLACK);
-	textPos.y += textDimensions.y * 1.618034f;
-	int mouseTileX, mouseTileY;
-	GetMouseTile(editor->camera, &mouseTileX, &mouseTileY);
-	text = TextFormat("Cursor Position: (%d, %d)", mouseTileX, mouseTileY);
-	DrawTextEx(editor->font, text, textPos, fontSize, fontSpacing, BLACK);
+	Workspace *workspace = &editor->workspace;
+
+	if (index < 0 || index >= workspace->count || index == workspace->active)
+		return;
+
+	WorkspaceEntry *entry = &workspace->entries[index];
+	if (entry->level.tiles != NULL || entry->isLoading)
+		return;
+
+	LevelLoadJob *job = (LevelLoadJob *)ZK_CALLOC(1, sizeof(*job));
+	assert(job != NULL);
+	job->editor = editor;
+	job->entryIndex = index;
+	job->source = entry->source;
+
+	entry->isLoading = true;
+	SubmitJob(&editor->jobs, CLITERAL(Job){RunLevelLoadJob, CompleteLevelLoadJob, job});
 }
 
-void Draw(Editor *editor)
+// Scaled down to fit a square, one sample per pixel.
+Image GenLevelThumbnail(Level level)
 {
-	Level level = editor->level;
+	Image image = GenImageColor(THUMBNAIL_SIZE, THUMBNAIL_SIZE, COLOR_BACKGROUND);
 
-	Color backgroundColor = COLOR_BACKGROUND;
+	if (level.tileCountX == 0 || level.tileCountY == 0)
+		return image;
 
-	if (editor->mode == MODE_PLAY)
+	int longestSide = level.tileCountX > level.tileCountY ? level.tileCountX : level.tileCountY;
+	int width = THUMBNAIL_SIZE * level.tileCountX / longestSide;
+	int height = THUMBNAIL_SIZE * level.tileCountY / longestSide;
+	if (width < 1) width = 1;
+	if (height < 1) height = 1;
+	int offsetX = (THUMBNAIL_SIZE - width) / 2;
+	int offsetY = (THUMBNAIL_SIZE - height) / 2;
+
+	Color *pixels = (Color *)image.data;
+	for (int y = 0; y < height; ++y)
 	{
-		backgroundColor = COLOR_BACKGROUND_PLAY;
-		if (IsPuzzleSolved(editor->level))
+		int tileY = y * level.tileCountY / height;
+		for (int x = 0; x < width; ++x)
 		{
-			backgroundColor = COLOR_BACKGROUND_PUZZLE_SOLVED;
+			int tileX = x * level.tileCountX / width;
+			pixels[(offsetY + y) * THUMBNAIL_SIZE + offsetX + x] = GetTileOverviewColor(*GetTile(level, tileX, tileY));
 		}
 	}
 
-	ClearBackground(backgroundColor);
-	BeginMode2D(editor->camera);
+	return image;
+}
+
+typedef struct ThumbnailJob
+{
+	Editor *editor;
+	int entryIndex;
+	LevelSource source;
+	// Levels with unsaved changes are drawn from a snapshot instead of the file
+	LevelSnapshot *snapshot;
+	Image image;
+} ThumbnailJob;
+
+void RunThumbnailJob(void *data)
+{
+	ThumbnailJob *job = (ThumbnailJob *)data;
+
+	if (job->snapshot != NULL)
 	{
-		DrawRectangle(0, 0, level.tileCountX*TILE_SIZE, level.tileCountY*TILE_SIZE, WHITE);
-		DrawTileGridLines(level.tileCountX, level.tileCountY);
-		DrawTileGrid(level, editor->font);
-		DrawTileCursor(editor);
-	
-		editor->violations.count = 0;
-		if (GetViolations(level, &editor->violations))
-		{
-			DrawViolations(&editor->violations);
-		}
+		job->image = GenLevelThumbnail(job->snapshot->level);
+		return;
 	}
-	EndMode2D();
 
-	if (editor->showDebugText)
+	Level level = {0};
+	if (TryLoadLevelSource(job->source, &level))
 	{
-		DrawDebugInfo(editor);
+		UpdateLitTiles(level, NULL, NULL, NULL);
 	}
+	job->image = GenLevelThumbnail(level);
+	free(level.tiles);
 }
 
-void PutTileLine(Level level, int xStart, int yStart, int xEnd, int yEnd, Tile tile)
+void CompleteThumbnailJob(void *data)
 {
-	int xDelta = xEnd - xStart;
-	int xStep = 1;
-	if (xEnd < xStart) { xStep = -1; xDelta = -xDelta; }
-	
-	int yDelta = yStart - yEnd;
-	int yStep = 1;
-	if (yEnd < yStart) { yStep = -1; yDelta = -yDelta; }
-	
-	int x = xStart;
-	int y = yStart;
-	int error = xDelta + yDelta;
+	ThumbnailJob *job = (ThumbnailJob *)data;
+	Workspace *workspace = &job->editor->workspace;
+	WorkspaceEntry *entry = &workspace->entries[job->entryIndex];
 
-	for (;;)
+	if (entry->thumbnail.id != 0)
 	{
-		PutTile(level, x, y, tile);
-		if (x == xEnd && y == yEnd) return;
+		UnloadTexture(entry->thumbnail);
+	}
+	entry->thumbnail = LoadTextureFromImage(job->image);
+	entry->isThumbnailPending = false;
+	--workspace->pendingThumbnailCount;
+	job->editor->needsRedraw = true;
+
+	UnloadImage(job->image);
+	ReleaseLevelSnapshot(job->snapshot);
+	free(job);
+}
 
-		int e2 = 2 * error;
+void RequestThumbnail(Editor *editor, int index)
+{
+	Workspace *workspace = &editor->workspace;
+	WorkspaceEntry *entry = &workspace->entries[index];
 
-		if (e2 >= yDelta)
+	ThumbnailJob *job = (ThumbnailJob *)ZK_CALLOC(1, sizeof(*job));
+	assert(job != NULL);
+	job->editor = editor;
+	job->entryIndex = index;
+	job->source = entry->source;
+
+	if (entry->isModified)
+	{
+		if (index == workspace->active)
 		{
-			if (x == xEnd) break;
-			error += yDelta;
-			x += xStep;
+			job->snapshot = AcquireLevelSnapshot(editor);
 		}
-
-		if (e2 <= xDelta)
+		else if (entry->level.tiles != NULL)
 		{
-			if (y == yEnd) break;
-			error += xDelta;
-			y += yStep;
+			job->snapshot = CreateLevelSnapshot(entry->level);
 		}
 	}
-}
 
-void CameraSetZoomTarget(Camera2D *camera, Vector2 target)
-{
-	Vector2 worldTarget = GetScreenToWorld2D(target, *camera);
-	camera->offset = target;
-	camera->target = worldTarget;
+	entry->isThumbnailPending = true;
+	entry->isThumbnailStale = false;
+	++workspace->pendingThumbnailCount;
+	SubmitJob(&editor->jobs, CLITERAL(Job){RunThumbnailJob, CompleteThumbnailJob, job});
 }
 
-void CameraZoomByFactor(Camera2D *camera, float zoomFactor, float zoomMin, float zoomMax)
+// Generate missing thumbnails in the selector strip a few at a time, and drop
+// the ones that scrolled far out of it.
+void UpdateWorkspaceThumbnails(Editor *editor)
 {
-	camera->zoom += zoomFactor * camera->zoom;
-	camera->zoom = Clamp(camera->zoom, zoomMin, zoomMax);
-}
+	Workspace *workspace = &editor->workspace;
 
-void UpdateLitTiles(Level level)
-{
-	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	if (!IsWorkspaceOpen(workspace))
+		return;
+
+	int first, end;
+	GetSelectorRange(workspace, &first, &end);
+
+	for (int index = first; index < end && workspace->pendingThumbnailCount < THUMBNAIL_MAX_PENDING; ++index)
 	{
-		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
+		WorkspaceEntry *entry = &workspace->entries[index];
+		if (!entry->isThumbnailPending && (entry->thumbnail.id == 0 || entry->isThumbnailStale))
 		{
-			Tile *tile = GetTile(level, tileX, tileY);
-			if (tile->kind == TILE_LIT)
-			{
-				tile->kind = TILE_EMPTY;
-			}
+			RequestThumbnail(editor, index);
 		}
 	}
 
-	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	for (int index = 0; index < workspace->count; ++index)
 	{
-		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
-		{
-			Tile *tile = GetTile(level, tileX, tileY);
-			if (tile->kind != TILE_LAMP)
-			{
-				continue;
-			}
-			
-			// ray right
-			for (int checkX = tileX + 1; checkX < level.tileCountX; ++checkX)
-			{
-				Tile *checkTile = GetTile(level, checkX, tileY);
-				if (checkTile->kind == TILE_EMPTY)
-				{
-					checkTile->kind = TILE_LIT;
-				}
-				else if (checkTile->kind == TILE_WALL)
-				{
-					break;
-				}
-			}
+		WorkspaceEntry *entry = &workspace->entries[index];
+		bool isFar = index < first - THUMBNAIL_KEEP_DISTANCE || index >= end + THUMBNAIL_KEEP_DISTANCE;
 
-			// ray left
-			for (int checkX = tileX - 1; checkX >= 0; --checkX)
-			{
-				Tile *checkTile = GetTile(level, checkX, tileY);
-				if (checkTile->kind == TILE_EMPTY)
-				{
-					checkTile->kind = TILE_LIT;
-				}
-				else if (checkTile->kind == TILE_WALL)
-				{
-					break;
-				}
-			}
-			
-			// ray down
-			for (int checkY = tileY + 1; checkY < level.tileCountY; ++checkY)
-			{
-				Tile *checkTile = GetTile(level, tileX, checkY);
-				if (checkTile->kind == TILE_EMPTY)
-				{
-					checkTile->kind = TILE_LIT;
-				}
-				else if (checkTile->kind == TILE_WALL)
-				{
-					break;
-				}
-			}
-			
-			// ray up
-			for (int checkY = tileY - 1; checkY >= 0; --checkY)
-			{
-				Tile *checkTile = GetTile(level, tileX, checkY);
-				if (checkTile->kind == TILE_EMPTY)
-				{
-					checkTile->kind = TILE_LIT;
-				}
-				else if (checkTile->kind == TILE_WALL)
-				{
-					break;
-				}
-			}
+		if (isFar && entry->thumbnail.id != 0 && !entry->isThumbnailPending)
+		{
+			UnloadTexture(entry->thumbnail);
+			entry->thumbnail = CLITERAL(Texture2D){0};
 		}
 	}
 }
 
-size_t GetSafeLevelStringSize(Level level)
+void SwitchWorkspaceLevel(Editor *editor, int index)
 {
-	const size_t size_for_width = 12;
-	const size_t size_for_height = 12;
+	Workspace *workspace = &editor->workspace;
 
-	return sizeof(char) * (
-		size_for_width + 1 +
-		size_for_height + 1 +
-		level.tileCountY * (level.tileCountX + 1) + 1);
-}
+	if (index < 0 || index >= workspace->count)
+		return;
 
-size_t SaveLevelToString(Level level, char *outputBuffer, size_t outputBufferSize)
-{
-	char *at = outputBuffer;
-	char *end = outputBuffer + outputBufferSize;
+	if (index == workspace->active)
+	{
+		workspace->pendingActive = -1;
+		return;
+	}
 
-	at += snprintf(at, (end - at), "%d\n%d\n", level.tileCountX, level.tileCountY);
+	WorkspaceEntry *entry = &workspace->entries[index];
 
-	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	// Parsing and lighting a big level takes longer than a frame, so that
+	// happens on a worker and Update finishes the switch once it is done
+	if (entry->level.tiles == NULL)
 	{
-		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
-		{
-			char c = '?';
-			Tile tile = *GetTile(level, tileX, tileY);
-			switch (tile.kind)
-			{
-				case TILE_WALL:
-				{
-					if (tile.lampRequirement >= 0)
-					{
-						c = tile.lampRequirement | '0';
-					}
-					else
-					{
-						c = '#';
-					}
-				} break;
+		PrefetchWorkspaceLevel(editor, index);
+		workspace->pendingActive = index;
+		editor->needsRedraw = true;
+		return;
+	}
+	workspace->pendingActive = -1;
 
-				case TILE_LAMP: c = 'L'; break;
+	if (workspace->active < 0)
+	{
+		// The level from before the workspace was opened lives on in the autosave
+		FlushAutosave(editor);
+		editor->autosave.isLevelModified = false;
+	}
 
-				case TILE_EMPTY:
-				case TILE_LIT: c = '.'; break;
-				default:
-					break;
-			}
+	if (workspace->active >= 0)
+	{
+		WorkspaceEntry *previous = &workspace->entries[workspace->active];
+		previous->level = editor->level;
+		previous->tileCountX = editor->level.tileCountX;
+		previous->tileCountY = editor->level.tileCountY;
+		previous->lastUsed = ++workspace->useCounter;
+		previous->isThumbnailStale |= previous->isModified;
+	}
+	else
+	{
+		free(editor->level.tiles);
+	}
 
-			at += snprintf(at, (end - at), "%c", c);
-		}
-		at += snprintf(at, (end - at), "\n");
+	editor->level = entry->level;
+	entry->level = CLITERAL(Level){0};
+	entry->lastUsed = ++workspace->useCounter;
+	workspace->active = index;
+
+	editor->isSelecting = false;
+	editor->isLevelSnapshotStale = true;
+	editor->needsRedraw = true;
+	ClearBranches(editor);
+	InvalidateLevel(&editor->renderCache);
+	UpdateViolations(editor);
+	CenterView(&editor->camera, editor->level);
+
+	// Levels in packs are not watched, packs are built, not edited
+	WatchFile(&editor->fileWatch, entry->source.pack == NULL ? entry->source.path : NULL);
+
+	EvictWorkspaceLevels(workspace);
+	PrefetchWorkspaceLevel(editor, index - 1);
+	PrefetchWorkspaceLevel(editor, index + 1);
+}
+
+void SaveWorkspaceLevel(Editor *editor)
+{
+	Workspace *workspace = &editor->workspace;
+
+	if (workspace->active < 0)
+		return;
+
+	WorkspaceEntry *entry = &workspace->entries[workspace->active];
+
+	if (entry->source.pack != NULL)
+	{
+		TraceLog(LOG_WARNING, "WORKSPACE: %s is a level pack and can not be saved to", entry->source.path);
+		return;
 	}
-	at += snprintf(at, (end - at), "%c", '\0');
 
-	return (size_t)(at - outputBuffer);
+	if (!SaveLevelFile(editor->level, entry->source.path))
+	{
+		TraceLog(LOG_WARNING, "WORKSPACE: Failed to write %s", entry->source.path);
+		return;
+	}
+
+	entry->tileCountX = editor->level.tileCountX;
+	entry->tileCountY = editor->level.tileCountY;
+	entry->isModified = false;
+	entry->isThumbnailStale = true;
+	editor->needsRedraw = true;
 }
 
-void EatWhitespace(char **at, char *end)
+// Workspace levels are not autosaved, so whatever is still unsaved on exit
+// goes to its file. Pack levels go next to the pack, packs are not written to.
+void SaveModifiedWorkspaceLevels(Editor *editor)
 {
-	while (*at < end && **at != '\0' && **at <= ' ') ++*at;
+	Workspace *workspace = &editor->workspace;
+
+	for (int index = 0; index < workspace->count; ++index)
+	{
+		WorkspaceEntry *entry = &workspace->entries[index];
+		Level level = (index == workspace->active) ? editor->level : entry->level;
+
+		if (!entry->isModified || level.tiles == NULL)
+			continue;
+
+		const char *path = entry->source.path;
+		if (entry->source.pack != NULL)
+		{
+			path = ArenaFormat(&editor->frameArena, "%s.%d.zenkari", entry->source.path, entry->source.packIndex + 1);
+		}
+
+		if (SaveLevelFile(level, path))
+		{
+			TraceLog(LOG_INFO, "WORKSPACE: Saved unsaved changes to %s", path);
+			entry->isModified = false;
+		}
+		else
+		{
+			TraceLog(LOG_WARNING, "WORKSPACE: Failed to write %s, unsaved changes are lost", path);
+		}
+	}
 }
 
-bool TryLoadLevelFromString(const char *buffer, size_t bufferSize, Level *outLevel)
+// The level matches its file again, so unlike an edit it leaves nothing to
+// save. Does here what Update does for a changed level, then the dirty flags
+// only ever stand for edits.
+void FinishLevelReload(Editor *editor, bool isLevelDirty)
 {
-	Level level = {0};
+	if (isLevelDirty)
+	{
+		UpdateViolations(editor);
+	}
+	else
+	{
+		editor->isPuzzleSolved = editor->violations.count == 0 && editor->unlitTileCount == 0;
+	}
+	editor->needsRedraw = true;
+	editor->isLevelSnapshotStale = true;
 
-	char *at = (char *)buffer;
-	char *end = at + bufferSize;
+	WorkspaceEntry *entry = &editor->workspace.entries[editor->workspace.active];
+	entry->isModified = false;
+	entry->isThumbnailStale = true;
+}
 
-	char *next_at;
-	level.tileCountX = strtol(at, &next_at, 10);
-	if (at == next_at) return false;
-	if (level.tileCountX > 2048) return false;
-	at = next_at;
-	EatWhitespace(&at, end);
-	level.tileCountY = strtol(at, &next_at, 10);
-	if (at == next_at) return false;
-	if (level.tileCountY > 2048) return false;
-	at = next_at;
+// Brings the open level in line with its file on disk. Rows are compared
+// against the file and only the differing tiles are written, so only those
+// get redrawn and, when there are few, relit and checked.
+void ReloadWatchedLevel(Editor *editor)
+{
+	const char *path = editor->fileWatch.path;
+	Level *level = &editor->level;
+	Level loaded = {0};
 
-	size_t allocAmount = sizeof(*level.tiles) * level.tileCountX * level.tileCountX;
-	level.tiles = (Tile *)realloc(outLevel->tiles, allocAmount);
-	assert(level.tiles != NULL);
-	memset(level.tiles, 0, allocAmount);
+	// Only workspace levels are watched
+	assert(editor->workspace.active >= 0);
+	if (editor->workspace.entries[editor->workspace.active].isModified)
+	{
+		// Saving writes the edits over the file, so nothing is reloaded until then
+		TraceLog(LOG_WARNING, "WATCH: %s changed on disk, kept the unsaved changes", path);
+		return;
+	}
 
-	for (int tileY = 0; tileY < level.tileCountY; ++tileY)
+	if (!TryLoadLevelFile(path, &loaded))
 	{
-		for (int tileX = 0; tileX < level.tileCountX; ++tileX)
-		{
-			EatWhitespace(&at, end);
-			if (at >= end) goto ErrorReturn;
+		// Most likely caught halfway through a write, the next one brings it in
+		TraceLog(LOG_WARNING, "WATCH: Failed to reload %s", path);
+		return;
+	}
 
-			char c = *at;
-			Tile *tile = GetTile(level, tileX, tileY);
-			switch (c)
-			{
-				case '#':
-				case '0':
-				case '1':
-				case '2':
-				case '3':
-				case '4':
-				{
-					tile->kind = TILE_WALL;
-					tile->lampRequirement = (c == '#') ? -1 : c - '0';
-				} break;
+	if (loaded.tileCountX != level->tileCountX || loaded.tileCountY != level->tileCountY)
+	{
+		free(level->tiles);
+		*level = loaded;
+		ClearBranches(editor);
+		UpdateLitTiles(*level, NULL, &editor->jobs, NULL);
+		InvalidateLevel(&editor->renderCache);
+		editor->isSelecting = false;
+		FinishLevelReload(editor, true);
+		TraceLog(LOG_INFO, "WATCH: Reloaded %s, resized to %dx%d", path, level->tileCountX, level->tileCountY);
+		return;
+	}
 
-				case 'L': tile->kind = TILE_LAMP; break;
+	// Positions are only kept while they can still be updated one by one
+	int *changedX = (int *)ArenaAlloc(&editor->frameArena, sizeof(int) * RELOAD_MAX_TILES_AROUND);
+	int *changedY = (int *)ArenaAlloc(&editor->frameArena, sizeof(int) * RELOAD_MAX_TILES_AROUND);
+	int changedCount = 0;
 
-				case '.': tile->kind = TILE_EMPTY; break;
+	for (int tileY = 0; tileY < level->tileCountY; ++tileY)
+	{
+		Tile *row = GetTile(*level, 0, tileY);
+		Tile *loadedRow = GetTile(loaded, 0, tileY);
 
-				default:
-					goto ErrorReturn;
-			}
+		for (int tileX = 0; tileX < level->tileCountX; ++tileX)
+		{
+			if (IsSameTile(row[tileX], loadedRow[tileX]))
+				continue;
 
-			++at;
+			editor->unlitTileCount += GetUnlitTileDelta(row[tileX].kind, loadedRow[tileX].kind);
+			row[tileX] = loadedRow[tileX];
+			InvalidateTile(&editor->renderCache, tileX, tileY);
+
+			if (changedCount < RELOAD_MAX_TILES_AROUND)
+			{
+				changedX[changedCount] = tileX;
+				changedY[changedCount] = tileY;
+			}
+			++changedCount;
 		}
-		EatWhitespace(&at, end);
 	}
 
-	*outLevel = level;
-	return true;
-
-ErrorReturn:
-	return false;
-}
-
+	free(loaded.tiles);
 
-float GetLevelWidth(Level level)
-{
-	return level.tileCountX * TILE_SIZE;
-}
+	if (changedCount == 0)
+		return;
 
-float GetLevelHeight(Level level)
-{
-	return level.tileCountY * TILE_SIZE;
-}
+	// Branch deltas would undo to what the tiles were before the reload
+	ClearBranches(editor);
 
-Vector2 GetViewportCenter()
-{
-	return CLITERAL(Vector2)
+	if (changedCount > RELOAD_MAX_TILES_AROUND)
 	{
-		GetRenderWidth() * 0.5f,
-		GetRenderHeight() * 0.5f,
-	};
+		UpdateLitTiles(*level, &editor->renderCache, &editor->jobs, NULL);
+	}
+	else
+	{
+		// All tiles are in place first, so every update sees the final level
+		for (int i = 0; i < changedCount; ++i)
+		{
+			editor->unlitTileCount += UpdateLitTilesAround(*level, changedX[i], changedY[i], &editor->renderCache);
+		}
+		for (int i = 0; i < changedCount; ++i)
+		{
+			UpdateViolationsAround(*level, changedX[i], changedY[i], &editor->violations);
+		}
+	}
+	FinishLevelReload(editor, changedCount > RELOAD_MAX_TILES_AROUND);
+
+	TraceLog(LOG_INFO, "WATCH: Reloaded %s, %d tiles changed", path, changedCount);
 }
 
-void CenterView(Camera2D *camera, Level level)
+void OpenDroppedFiles(Editor *editor)
 {
-	float levelWidth = GetLevelWidth(level);
-	float levelHeight = GetLevelHeight(level);
+	FilePathList files = LoadDroppedFiles();
+	int firstNewEntry = editor->workspace.count;
 
-	float widthRatio = GetRenderWidth() / levelWidth;
-	float heightRatio = GetRenderHeight() / levelHeight;
-
-	camera->zoom = widthRatio < heightRatio ? widthRatio : heightRatio;
-	camera->zoom *= 0.90;
-
-	camera->target = CLITERAL(Vector2)
+	for (unsigned int i = 0; i < files.count; ++i)
 	{
-		0.5f*levelWidth,
-		0.5f*levelHeight,
-	};
-
-	camera->offset = GetViewportCenter();
+		AddWorkspacePath(&editor->workspace, files.paths[i]);
+	}
+	UnloadDroppedFiles(files);
 
+	SwitchWorkspaceLevel(editor, firstNewEntry);
 }
 
 void HandleInput(Editor *editor)
@@ -836,6 +4478,24 @@ void HandleInput(Editor *editor)
 	Vector2 mousePosition = GetMousePosition();
 	Vector2 mouseDifference = Vector2Subtract(mousePosition, editor->previousMousePosition);
 
+	editor->isInteracting =
+		IsMouseButtonDown(MOUSE_BUTTON_LEFT) ||
+		IsMouseButtonDown(MOUSE_BUTTON_RIGHT) ||
+		IsMouseButtonDown(MOUSE_BUTTON_MIDDLE) ||
+		IsKeyDown(KEY_SPACE);
+
+	// The cursor and the debug text follow the mouse, so any input may change the frame
+	if (editor->isInteracting
+		|| wheel != 0
+		|| mouseDifference.x != 0 || mouseDifference.y != 0
+		|| GetKeyPressed() != 0
+		|| IsMouseButtonReleased(MOUSE_BUTTON_LEFT)
+		|| IsMouseButtonReleased(MOUSE_BUTTON_RIGHT)
+		|| IsMouseButtonReleased(MOUSE_BUTTON_MIDDLE))
+	{
+		editor->needsRedraw = true;
+	}
+
 	if (IsKeyPressed(KEY_F11) || (IsKeyDown(KEY_LEFT_ALT) && IsKeyPressed(KEY_ENTER)))
 	{
 		int monitor = GetCurrentMonitor();
@@ -855,13 +4515,17 @@ void HandleInput(Editor *editor)
 
 	if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL))
 	{
+		if (IsKeyPressed(KEY_S))
+		{
+			SaveWorkspaceLevel(editor);
+		}
+
 		if (IsKeyPressed(KEY_C))
 		{
 			size_t bufferSize = GetSafeLevelStringSize(editor->level);
-			char *buffer = malloc(bufferSize);
+			char *buffer = (char *)ArenaAlloc(&editor->frameArena, bufferSize);
 			SaveLevelToString(editor->level, buffer, bufferSize);
 			SetClipboardText(buffer);
-			free(buffer);
 		}
 
 		if (IsKeyPressed(KEY_V))
@@ -871,11 +4535,39 @@ void HandleInput(Editor *editor)
 
 			if (TryLoadLevelFromString(levelString, levelStringLength, &editor->level))
 			{
-				UpdateLitTiles(editor->level);
+				ClearBranches(editor);
+				UpdateLitTiles(editor->level, NULL, &editor->jobs, NULL);
+				InvalidateLevel(&editor->renderCache);
+				editor->isLevelDirty = true;
 			}
 		}
 	}
 
+	if (IsKeyPressed(KEY_PAGE_UP))
+	{
+		SwitchWorkspaceLevel(editor, editor->workspace.active - 1);
+	}
+
+	if (IsKeyPressed(KEY_PAGE_DOWN))
+	{
+		SwitchWorkspaceLevel(editor, editor->workspace.active + 1);
+	}
+
+	bool isOverSelector = IsWorkspaceOpen(&editor->workspace)
+		&& CheckCollisionPointRec(mousePosition, GetSelectorBounds());
+
+	if (isOverSelector && IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
+	{
+		int first, end;
+		GetSelectorRange(&editor->workspace, &first, &end);
+		int index = first + (int)(mousePosition.x / SELECTOR_SLOT_WIDTH);
+
+		if (index < end)
+		{
+			SwitchWorkspaceLevel(editor, index);
+		}
+	}
+
 	if (IsKeyPressed(KEY_TAB))
 	{
 		if (editor->mode == MODE_EDIT)
@@ -887,6 +4579,48 @@ void HandleInput(Editor *editor)
 		{
 			editor->mode = MODE_EDIT;
 			editor->tileToDraw = CLITERAL(Tile){TILE_WALL, .lampRequirement = -1};
+			ClearBranches(editor);
+		}
+	}
+
+	// Alt+Arrow keys move the right and bottom edges of the level
+	if (editor->mode == MODE_EDIT && (IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT)))
+	{
+		int tileCountX = editor->level.tileCountX;
+		int tileCountY = editor->level.tileCountY;
+
+		if (IsKeyPressed(KEY_RIGHT)) ++tileCountX;
+		if (IsKeyPressed(KEY_LEFT)) --tileCountX;
+		if (IsKeyPressed(KEY_DOWN)) ++tileCountY;
+		if (IsKeyPressed(KEY_UP)) --tileCountY;
+
+		tileCountX = Clamp(tileCountX, 1, LEVEL_MAX_TILE_COUNT);
+		tileCountY = Clamp(tileCountY, 1, LEVEL_MAX_TILE_COUNT);
+
+		if (tileCountX != editor->level.tileCountX || tileCountY != editor->level.tileCountY)
+		{
+			ResizeLevel(&editor->level, tileCountX, tileCountY);
+			UpdateLitTiles(editor->level, NULL, &editor->jobs, NULL);
+			InvalidateLevel(&editor->renderCache);
+			editor->isSelecting = false;
+			editor->isLevelDirty = true;
+		}
+	}
+
+	// What if branches: B opens one, Enter keeps it, Backspace throws it away
+	if (editor->mode == MODE_PLAY)
+	{
+		if (IsKeyPressed(KEY_B))
+		{
+			StartBranch(editor);
+		}
+		else if (IsKeyPressed(KEY_ENTER) && !IsKeyDown(KEY_LEFT_ALT))
+		{
+			CommitBranch(editor);
+		}
+		else if (IsKeyPressed(KEY_BACKSPACE))
+		{
+			DiscardBranch(editor);
 		}
 	}
 
@@ -912,8 +4646,11 @@ void HandleInput(Editor *editor)
 			zoomFactor = 3.0*mouseDifference.x / GetRenderWidth();
 		}
 
+		// Allow zooming out far enough to get an overview of large levels
+		float zoomMin = fminf(0.05f, 0.5f * GetZoomToFit(editor->level));
+
 		CameraSetZoomTarget(&editor->camera, zoomTarget);
-		CameraZoomByFactor(&editor->camera, zoomFactor, 0.05f, 10.0f);
+		CameraZoomByFactor(&editor->camera, zoomFactor, zoomMin, 10.0f);
 	}
 	else if (wheel != 0)
 	{
@@ -937,6 +4674,10 @@ void HandleInput(Editor *editor)
 		SetMouseCursor(MOUSE_CURSOR_RESIZE_ALL);
 		editor->camera.offset = Vector2Add(editor->camera.offset, mouseDifference);
 	}
+	else if (isOverSelector && !editor->isSelecting)
+	{
+		SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
+	}
 	else if (!isZooming)
 	{
 		SetMouseCursor(MOUSE_CURSOR_DEFAULT);
@@ -947,8 +4688,41 @@ void HandleInput(Editor *editor)
 
 		if (editor->mode == MODE_EDIT)
 		{
+			bool isShiftDown = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+
+			// Shift drag fills a rectangle, with the right mouse button it clears it
+			if (!editor->isSelecting && isShiftDown
+				&& (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)))
+			{
+				editor->isSelecting = true;
+				editor->isSelectionClear = IsMouseButtonPressed(MOUSE_BUTTON_RIGHT);
+				editor->selectionStartX = mouseTileX;
+				editor->selectionStartY = mouseTileY;
+			}
+
+			if (editor->isSelecting)
+			{
+				editor->selectionEndX = mouseTileX;
+				editor->selectionEndY = mouseTileY;
+
+				if (!IsMouseButtonDown(MOUSE_BUTTON_LEFT) && !IsMouseButtonDown(MOUSE_BUTTON_RIGHT))
+				{
+					Tile tile = editor->tileToDraw;
+					if (editor->isSelectionClear)
+					{
+						tile = CLITERAL(Tile){TILE_EMPTY};
+					}
+
+					if (FillTileRect(editor->level, GetSelectionRect(editor), tile, &editor->renderCache))
+					{
+						UpdateLitTiles(editor->level, &editor->renderCache, &editor->jobs, &editor->frameArena);
+						editor->isLevelDirty = true;
+					}
+					editor->isSelecting = false;
+				}
+			}
 			// Place tile with left mouse button
-			if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsMouseButtonDown(MOUSE_BUTTON_RIGHT))
+			else if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsMouseButtonDown(MOUSE_BUTTON_RIGHT))
 			{
 
 				int prevMouseTileX;
@@ -962,27 +4736,46 @@ void HandleInput(Editor *editor)
 					tile = CLITERAL(Tile){TILE_EMPTY};
 				}
 
-				PutTileLine(editor->level, prevMouseTileX, prevMouseTileY, mouseTileX, mouseTileY, tile);
-				UpdateLitTiles(editor->level);
+				if (PutTileLine(editor->level, prevMouseTileX, prevMouseTileY, mouseTileX, mouseTileY, tile, &editor->renderCache))
+				{
+					UpdateLitTiles(editor->level, &editor->renderCache, &editor->jobs, &editor->frameArena);
+					editor->isLevelDirty = true;
+				}
+			}
+
+			if (IsKeyPressed(KEY_G))
+			{
+				if (FloodFillTiles(editor->level, mouseTileX, mouseTileY, editor->tileToDraw, &editor->renderCache))
+				{
+					UpdateLitTiles(editor->level, &editor->renderCache, &editor->jobs, &editor->frameArena);
+					editor->isLevelDirty = true;
+				}
 			}
 
 			Tile *tile = NULL;
 			if (TryGetTile(editor->level, mouseTileX, mouseTileY, &tile))
 			{
+				int lampRequirement = tile->lampRequirement;
+
 				if (IsKeyPressed(KEY_ONE))              tile->lampRequirement = 1;
 				else if (IsKeyPressed(KEY_TWO))         tile->lampRequirement = 2;
 				else if (IsKeyPressed(KEY_THREE))       tile->lampRequirement = 3;
 				else if (IsKeyPressed(KEY_FOUR))        tile->lampRequirement = 4;
 				else if (IsKeyPressed(KEY_ZERO))        tile->lampRequirement = 0;
 				else if (IsKeyPressed(KEY_BACKSPACE))   tile->lampRequirement = -1;
+
+				if (tile->lampRequirement != lampRequirement)
+				{
+					InvalidateTile(&editor->renderCache, mouseTileX, mouseTileY);
+					editor->isLevelDirty = true;
+				}
 			}
 		}
 		else
 		{
 			if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonPressed(MOUSE_BUTTON_RIGHT))
 			{
-				Tile *tile = NULL;
-				if (TryGetTile(editor->level, mouseTileX, mouseTileY, &tile) && tile->kind != TILE_WALL)
+				if (IsTileInLevel(editor->level, mouseTileX, mouseTileY))
 				{
 					TileKind tileKind = TILE_LAMP;
 					if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT))
@@ -990,8 +4783,7 @@ void HandleInput(Editor *editor)
 						tileKind = TILE_EMPTY;
 					}
 
-					tile->kind = tileKind;
-					UpdateLitTiles(editor->level);
+					SetPlayTile(editor, mouseTileX, mouseTileY, tileKind);
 				}
 			}
 		}
@@ -1008,13 +4800,84 @@ void ReadjustViewport(Editor *editor)
 		Vector2 viewportCenterDiff = Vector2Subtract(viewportCenter, editor->previousViewportCenter);
 		editor->camera.offset = Vector2Add(editor->camera.offset, viewportCenterDiff);
 		editor->previousViewportCenter = viewportCenter;
+		editor->needsRedraw = true;
 	}
 }
 
+bool CameraEquals(Camera2D a, Camera2D b)
+{
+	return a.offset.x == b.offset.x && a.offset.y == b.offset.y
+		&& a.target.x == b.target.x && a.target.y == b.target.y
+		&& a.rotation == b.rotation && a.zoom == b.zoom;
+}
+
 void Update(Editor *editor)
 {
+	Camera2D previousCamera = editor->camera;
+
+	// Counted over Update and Draw of the frame before, background jobs included
+	int allocationCount = GetHeapAllocationCount();
+	editor->lastFrameHeapAllocationCount = allocationCount - editor->heapAllocationCountAtFrameStart;
+	editor->heapAllocationCountAtFrameStart = allocationCount;
+	ResetArena(&editor->frameArena);
+
+	RunCompletedJobs(&editor->jobs);
+
+	int pendingActive = editor->workspace.pendingActive;
+	if (pendingActive >= 0 && editor->workspace.entries[pendingActive].level.tiles != NULL)
+	{
+		SwitchWorkspaceLevel(editor, pendingActive);
+	}
+
+	if (HasWatchedFileChanged(&editor->fileWatch))
+	{
+		ReloadWatchedLevel(editor);
+	}
+
+	if (IsFileDropped())
+	{
+		OpenDroppedFiles(editor);
+	}
+
 	ReadjustViewport(editor);
-	HandleInput(editor);
+	// There is no level to edit while the placeholder is up
+	if (editor->workspace.pendingActive < 0)
+	{
+		HandleInput(editor);
+	}
+
+	if (editor->isLevelDirty || editor->isLevelTouched)
+	{
+		if (editor->isLevelDirty)
+		{
+			UpdateViolations(editor);
+		}
+		else
+		{
+			editor->isPuzzleSolved = editor->violations.count == 0 && editor->unlitTileCount == 0;
+		}
+		editor->isLevelDirty = false;
+		editor->isLevelTouched = false;
+		editor->needsRedraw = true;
+		editor->isLevelSnapshotStale = true;
+
+		if (editor->workspace.active >= 0)
+		{
+			WorkspaceEntry *entry = &editor->workspace.entries[editor->workspace.active];
+			entry->isModified = true;
+		}
+		else
+		{
+			editor->autosave.isLevelModified = true;
+		}
+	}
+
+	UpdateWorkspaceThumbnails(editor);
+
+	if (!CameraEquals(previousCamera, editor->camera))
+	{
+		editor->needsRedraw = true;
+	}
 }
 
 void Init(Editor *editor)
@@ -1032,34 +4895,193 @@ void Init(Editor *editor)
 		.camera = {
 			.zoom = 1.0f,
 		},
+		.workspace = {
+			.active = -1,
+			.pendingActive = -1,
+		},
+		.needsRedraw = true,
 	};
 
 	Level *level = &editor->level;
-	level->tiles = (Tile *)calloc(level->tileCountX * level->tileCountY, sizeof(*level->tiles));
+	*level = CreateLevel(level->tileCountX, level->tileCountY);
 
+	if (TryLoadLevelCompressed(AUTOSAVE_PATH, level))
+	{
+		TraceLog(LOG_INFO, "AUTOSAVE: Restored level from %s", AUTOSAVE_PATH);
+		UpdateLitTiles(*level, NULL, NULL, NULL);
+	}
+	UpdateViolations(editor);
+
+	StartJobSystem(&editor->jobs);
+	StartFileWatch(&editor->fileWatch);
+	StartWakeTimer(&editor->wakeTimer);
+	editor->autosave.lastSaveTime = GetTime();
 
 	editor->previousViewportCenter = GetViewportCenter();
 
 	CenterView(&editor->camera, editor->level);
 
-	const char *fontPath = "assets/oswald.ttf";
-	editor->font = LoadFontEx(fontPath, 256, NULL, 0);
-	GenTextureMipmaps(&editor->font.texture);
+	editor->font = LoadBakedFont();
 	SetTextureFilter(editor->font.texture, TEXTURE_FILTER_TRILINEAR);
 	SetTextureWrap(editor->font.texture, TEXTURE_WRAP_CLAMP);
 }
 
-int main(void)
+// Headless: zenkari --pack <output.zkpack> <files or directories...>
+int BuildLevelPack(const char *outputPath, int inputCount, char **inputs)
+{
+	Workspace workspace = {0};
+	for (int i = 0; i < inputCount; ++i)
+	{
+		AddWorkspacePath(&workspace, inputs[i]);
+	}
+
+	Level *levels = (Level *)ZK_CALLOC(workspace.count + 1, sizeof(*levels));
+	assert(levels != NULL);
+
+	int levelCount = 0;
+	for (int index = 0; index < workspace.count; ++index)
+	{
+		if (TryLoadLevelSource(workspace.entries[index].source, &levels[levelCount]))
+		{
+			++levelCount;
+		}
+		else
+		{
+			fprintf(stderr, "%s: not a valid level, skipped\n", workspace.entries[index].source.path);
+		}
+	}
+
+	bool saved = SaveLevelPack(outputPath, levels, levelCount);
+	if (saved)
+	{
+		printf("%s: %d levels\n", outputPath, levelCount);
+	}
+	else
+	{
+		fprintf(stderr, "%s: failed to write\n", outputPath);
+	}
+
+	for (int index = 0; index < levelCount; ++index)
+	{
+		free(levels[index].tiles);
+	}
+	free(levels);
+
+	return saved ? 0 : 1;
+}
+
+// Headless: zenkari --validate <pack.zkpack>
+// Goes through every level in order and prints one line per level, for batch
+// checking. Fails if any level is corrupt.
+int ValidateLevelPack(const char *path)
+{
+	LevelPack pack;
+	if (!TryOpenLevelPack(path, &pack))
+	{
+		fprintf(stderr, "%s: not a valid level pack\n", path);
+		return 1;
+	}
+
+	int failedCount = 0;
+	Level level = {0};
+	Violations violations = {0};
+
+	for (int index = 0; index < pack.levelCount; ++index)
+	{
+		if (!IsPackedLevelIntact(&pack, index))
+		{
+			printf("%s #%d: hash mismatch\n", path, index + 1);
+			++failedCount;
+			continue;
+		}
+
+		if (!TryLoadPackedLevel(&pack, index, &level))
+		{
+			printf("%s #%d: does not parse\n", path, index + 1);
+			++failedCount;
+			continue;
+		}
+
+		UpdateLitTiles(level, NULL, NULL, NULL);
+		violations.count = 0;
+		bool hasViolations = GetViolations(level, &violations, NULL);
+		bool isSolved = !hasViolations && !HasUnlitTiles(level);
+		printf("%s #%d: %dx%d, %d violations%s\n", path, index + 1, level.tileCountX, level.tileCountY, violations.count, isSolved ? ", solved" : "");
+	}
+
+	printf("%s: %d levels, %d failed\n", path, pack.levelCount, failedCount);
+
+	free(level.tiles);
+	free(violations.items);
+	CloseLevelPack(&pack);
+
+	return failedCount == 0 ? 0 : 1;
+}
+
+// Any arguments are level files, level packs or directories of them to open
+// as a workspace.
+int main(int argc, char **argv)
 {
+	if (argc >= 3 && strcmp(argv[1], "--pack") == 0)
+	{
+		SetTraceLogLevel(LOG_WARNING);
+		return BuildLevelPack(argv[2], argc - 3, argv + 3);
+	}
+
+	if (argc == 3 && strcmp(argv[1], "--validate") == 0)
+	{
+		SetTraceLogLevel(LOG_WARNING);
+		return ValidateLevelPack(argv[2]);
+	}
+
 	Editor editor;
 	Init(&editor);
 
+	for (int i = 1; i < argc; ++i)
+	{
+		AddWorkspacePath(&editor.workspace, argv[i]);
+	}
+	SwitchWorkspaceLevel(&editor, 0);
+
 	while (!WindowShouldClose())
 	{
 		Update(&editor);
-		BeginDrawing();
-		Draw(&editor);
-		EndDrawing();
+
+		if (editor.needsRedraw)
+		{
+			DisableEventWaiting();
+			BeginDrawing();
+			Draw(&editor);
+			EndDrawing();
+
+			// Keep the full frame rate going for as long as a drag or zoom lasts
+			editor.needsRedraw = editor.isInteracting;
+		}
+		else if (HasPendingCompletions(&editor.jobs))
+		{
+			// Background work can finish at any moment, keep polling instead of sleeping
+			DisableEventWaiting();
+			PollInputEvents();
+			WaitTime(1.0 / 30.0);
+		}
+		else
+		{
+			// Nothing could have changed on screen, sleep until the next input
+			// event, a watched file change or a due autosave
+			double autosaveDelay = GetAutosaveDelay(&editor);
+			if (autosaveDelay >= 0.0)
+			{
+				ArmWakeTimer(&editor.wakeTimer, autosaveDelay);
+			}
+			EnableEventWaiting();
+			PollInputEvents();
+		}
+
+		UpdateAutosave(&editor);
 	}
+
+	FlushAutosave(&editor);
+	SaveModifiedWorkspaceLevels(&editor);
+	StopJobSystem(&editor.jobs);
 	return 0;
 }